@@ -301,6 +301,27 @@ def wrap_end(end_func):
     return inner
 
 
+def expand_style(cmd):
+    """
+    Replaces a PlotStyle argument by the equivalent keyword arguments.
+    """
+
+    style = cmd.kwargs.pop("style", None)
+
+    if style is None:
+        return
+
+    cmd.kwargs["fmt"] = style.fmt
+    # an explicit color takes precedence over the one of the style
+    if not (hasattr(style.color, "size") and style.color.size == 0):
+        cmd.kwargs.setdefault("color", style.color)
+    cmd.kwargs["line_weight"] = style.line_weight
+    cmd.kwargs["marker_size"] = style.marker_size
+    cmd.kwargs["marker_weight"] = style.marker_weight
+    cmd.kwargs["shade_alpha"] = style.shade_alpha
+    cmd.kwargs.setdefault("flags", style.flags)
+
+
 def export_cmd_drag_point(cmd, p):
 
     point = cmd.args[1]
@@ -319,6 +340,8 @@ def export_cmd_drag_point(cmd, p):
 
 def export_cmd_plot_circle(cmd, p):
 
+    expand_style(cmd)
+
     center = cmd.args[0]
     radius = cmd.args[1]
     label = cmd.opt_arg(2, "label", "")
@@ -349,6 +372,8 @@ def export_cmd_plot_circle(cmd, p):
 
 def export_cmd_plot_rect(cmd, p):
 
+    expand_style(cmd)
+
     position = cmd.args[0]
     size = cmd.args[1]
     label = cmd.opt_arg(2, "label", "")
@@ -377,6 +402,8 @@ def export_cmd_plot_rect(cmd, p):
 
 def export_cmd_plot(cmd, p):
 
+    expand_style(cmd)
+
     fmt = cmd.opt_arg(2, "fmt", "-")
 
     kwargs = {}
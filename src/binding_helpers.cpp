@@ -1,5 +1,36 @@
 #include "binding_helpers.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+py::array asArray(py::handle obj) {
+
+    if (py::isinstance<py::array>(obj)) {
+        return py::reinterpret_borrow<py::array>(obj);
+    }
+
+    py::array array = py::array::ensure(obj);
+
+    if (!array) {
+        throw py::type_error("Cannot convert "
+                + std::string(py::str(obj.get_type().attr("__name__")))
+                + " to an array");
+    }
+
+    if (0 == array.ndim()) {
+        array = py::array(array.dtype(), {1}, {}, array.data(), array);
+    }
+
+    return array;
+}
+
 std::string shapeToStr(py::array& array) {
 
     std::stringstream ss;
@@ -221,37 +252,326 @@ ImageInfo interpretImage(py::array& image) {
     return i;
 }
 
-GLuint uploadImage(std::string id, ImageInfo& i, py::array& image, bool skip, bool lerp) {
+bool interpretImageRect(py::handle& rect, ImageRect& r) {
+
+    if (rect.is_none()) {
+        return false;
+    }
+
+    py::sequence seq = py::cast<py::sequence>(rect);
+
+    if (seq.size() != 4) {
+        throw py::value_error("Expected a rect of the form (x, y, width, height)");
+    }
+
+    r.x = py::cast<int>(seq[0]);
+    r.y = py::cast<int>(seq[1]);
+    r.width = py::cast<int>(seq[2]);
+    r.height = py::cast<int>(seq[3]);
+
+    return true;
+}
+
+// number of pixel buffers per streamed texture
+static constexpr int STREAM_BUFFERS = 3;
 
-    static std::unordered_map<ImGuiID, GLuint> textureCache;
+// copies into pixel buffers are split into parts of at least this size
+static constexpr size_t STREAM_COPY_PART = 1 << 20;
 
-    ImGuiID uniqueId = ImGui::GetID(id.c_str());
+/**
+ * Pixel unpack buffers of a streamed texture.
+ *
+ * An image is copied into one of the buffers, from which the driver
+ * updates the texture asynchronously. The buffers are used in turn and
+ * a fence per buffer prevents overwriting one, which is still read.
+ */
 
-    // create a texture if necessary
-    
-    if (textureCache.find(uniqueId) == textureCache.end()) {
+struct StreamBuffers {
 
-        GLuint textureId;
+    GLuint pbos[STREAM_BUFFERS] = {};
+    GLsync fences[STREAM_BUFFERS] = {};
 
-        glGenTextures(1, &textureId);
-        glBindTexture(GL_TEXTURE_2D, textureId);
+    // persistent mappings, null if buffer storage is not supported
+    void* mapped[STREAM_BUFFERS] = {};
 
-        glBindTexture(GL_TEXTURE_2D, 0);
+    size_t size = 0;
+    int next = 0;
 
-        textureCache[uniqueId] = textureId;
+    StreamBuffers(size_t size);
+    ~StreamBuffers();
+};
 
-        skip = false;
+StreamBuffers::StreamBuffers(size_t size) : size(size) {
+
+    glGenBuffers(STREAM_BUFFERS, pbos);
+
+    for (int k = 0; k < STREAM_BUFFERS; ++k) {
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[k]);
+
+        if (GLEW_ARB_buffer_storage) {
+            GLbitfield flags = GL_MAP_WRITE_BIT
+                | GL_MAP_PERSISTENT_BIT
+                | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, size, nullptr, flags);
+            mapped[k] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, flags);
+        } else {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+        }
     }
 
-    // upload texture
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+StreamBuffers::~StreamBuffers() {
+
+    for (int k = 0; k < STREAM_BUFFERS; ++k) {
+        if (fences[k] != nullptr) {
+            glDeleteSync(fences[k]);
+        }
+    }
+
+    // deleting mapped buffers unmaps them
+    glDeleteBuffers(STREAM_BUFFERS, pbos);
+}
+
+/**
+ * A cached texture and the layout of its storage.
+ */
+
+struct CachedTexture {
+
+    GLuint id = 0;
+
+    int width = 0;
+    int height = 0;
+    int levels = 0;
+    GLenum internalFormat = 0;
+
+    std::unique_ptr<StreamBuffers> stream;
+
+    // estimated gpu memory of the texture and its pixel buffers
+    size_t bytes = 0;
+
+    // hash of the uploaded image, if it was uploaded as a whole
+    bool hasContentHash = false;
+    uint64_t contentHash = 0;
+
+    // mipmaps are only generated once the texture is drawn minified
+    bool mipmapsValid = false;
+    int minifiedFrame = -1;
+
+    GLint minFilter = 0;
+    GLint magFilter = 0;
+
+    int lastFrame = -1;
+    std::list<ImGuiID>::iterator lruPos;
+};
+
+static std::unordered_map<ImGuiID, CachedTexture> textureCache;
+
+// ids of the cached textures, most recently used first
+static std::list<ImGuiID> lruOrder;
+
+static size_t textureBytes = 0;
+static size_t textureBudget = DEFAULT_TEXTURE_BUDGET;
+static size_t textureEvictions = 0;
+
+// replaced textures and their last frame, whose draw lists may still use them
+static std::vector<std::pair<GLuint, int>> retiredTextures;
+
+static size_t bytesPerPixel(GLenum internalFormat) {
+
+    switch (internalFormat) {
+        case GL_R8: return 1;
+        case GL_RGB8: return 3;
+        case GL_RGBA8: return 4;
+        case GL_R32F: return 4;
+        case GL_RGB32F: return 12;
+        case GL_RGBA32F: return 16;
+        default: return 4;
+    }
+}
+
+/**
+ * Updates the memory of the texture and the total after changes.
+ */
+
+static void updateTextureBytes(CachedTexture& t) {
+
+    size_t bytes = 0;
+
+    for (int level = 0; level < t.levels; ++level) {
+        bytes += (size_t)std::max(1, t.width >> level)
+            * (size_t)std::max(1, t.height >> level)
+            * bytesPerPixel(t.internalFormat);
+    }
+
+    if (t.stream != nullptr) {
+        bytes += STREAM_BUFFERS * t.stream->size;
+    }
+
+    textureBytes = textureBytes - t.bytes + bytes;
+    t.bytes = bytes;
+}
+
+static void releaseTexture(CachedTexture& t) {
+
+    if (t.id != 0 && t.lastFrame >= ImGui::GetFrameCount()) {
+        retiredTextures.emplace_back(t.id, t.lastFrame);
+        t.id = 0;
+    } else if (t.id != 0) {
+        glDeleteTextures(1, &t.id);
+        t.id = 0;
+    }
+
+    t.stream.reset();
+
+    textureBytes -= t.bytes;
+    t.bytes = 0;
+}
+
+/**
+ * Deletes the retired textures, once their frame has been rendered.
+ */
+
+static void deleteRetiredTextures() {
+
+    int frame = ImGui::GetFrameCount();
+
+    auto end = std::remove_if(retiredTextures.begin(), retiredTextures.end(),
+            [&](const std::pair<GLuint, int>& r) {
+        if (r.second >= frame) {
+            return false;
+        }
+        glDeleteTextures(1, &r.first);
+        return true;
+    });
+
+    retiredTextures.erase(end, retiredTextures.end());
+}
+
+/**
+ * Deletes the least recently used textures until the budget is met.
+ * Textures used in the current frame are still referenced by its draw
+ * lists and are therefore kept, even if this exceeds the budget.
+ */
+
+static void evictTextures() {
+
+    if (textureBudget == 0) {
+        return;
+    }
+
+    int frame = ImGui::GetFrameCount();
+
+    while (textureBytes > textureBudget && !lruOrder.empty()) {
+
+        auto it = textureCache.find(lruOrder.back());
+
+        if (it->second.lastFrame >= frame) {
+            break;
+        }
+
+        releaseTexture(it->second);
+        textureCache.erase(it);
+        lruOrder.pop_back();
+
+        textureEvictions += 1;
+    }
+}
+
+void setTextureBudget(size_t bytes) {
+
+    textureBudget = bytes;
+
+    evictTextures();
+}
+
+TextureCacheStats getTextureCacheStats() {
+
+    TextureCacheStats stats;
+
+    stats.textures = textureCache.size();
+    stats.bytes = textureBytes;
+    stats.budget = textureBudget;
+    stats.evictions = textureEvictions;
+
+    return stats;
+}
+
+/**
+ * Images are displayed with 8 bits per channel, float images included,
+ * which are normalized by the driver during the upload. Textures, which
+ * need the full precision, request their format explicitly.
+ */
+
+static GLenum sizedInternalFormat(const ImageInfo& i) {
 
-    GLuint textureId = textureCache[uniqueId];
+    if (i.internalFormat != 0) {
+        return i.internalFormat;
+    }
 
-    if (skip) {
-        return textureId;
+    if (i.format == GL_RED) {
+        return GL_R8;
+    } else if (i.format == GL_RGB) {
+        return GL_RGB8;
     }
 
-    glBindTexture(GL_TEXTURE_2D, textureId);
+    return GL_RGBA8;
+}
+
+static int mipLevels(int width, int height) {
+
+    int levels = 1;
+
+    while ((std::max(width, height) >> levels) > 0) {
+        levels += 1;
+    }
+
+    return levels;
+}
+
+/**
+ * Replaces the texture with one of the layout of the image.
+ * Immutable storage cannot be resized, so a new texture is created.
+ * This is also the case, once mipmaps are needed for the first time.
+ */
+
+static void allocateTexture(CachedTexture& t, const ImageInfo& i, GLenum internalFormat, bool mipmaps) {
+
+    releaseTexture(t);
+
+    t.hasContentHash = false;
+    t.mipmapsValid = false;
+    t.minFilter = 0;
+    t.magFilter = 0;
+
+    t.width = i.imageWidth;
+    t.height = i.imageHeight;
+    t.levels = mipmaps ? mipLevels(t.width, t.height) : 1;
+    t.internalFormat = internalFormat;
+
+    glGenTextures(1, &t.id);
+    glBindTexture(GL_TEXTURE_2D, t.id);
+
+    if (GLEW_ARB_texture_storage) {
+        glTexStorage2D(GL_TEXTURE_2D, t.levels, internalFormat, t.width, t.height);
+    } else {
+        // the same layout in mutable storage, which is never respecified
+        for (int level = 0; level < t.levels; ++level) {
+            glTexImage2D(GL_TEXTURE_2D,
+                         level,
+                         internalFormat,
+                         std::max(1, t.width >> level),
+                         std::max(1, t.height >> level),
+                         0,
+                         i.format,
+                         i.datatype,
+                         nullptr);
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, t.levels - 1);
+    }
 
     if (i.format == GL_RED) {
         GLint swizzleMask[] = {GL_RED, GL_RED, GL_RED, GL_ONE};
@@ -264,17 +584,244 @@ GLuint uploadImage(std::string id, ImageInfo& i, py::array& image, bool skip, bo
         glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzleMask);
     }
 
-    // setup parameters for display
-
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    if (lerp) {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    updateTextureBytes(t);
+}
+
+/**
+ * xxHash64 (https://github.com/Cyan4973/xxHash) of a block of memory.
+ */
+
+static constexpr uint64_t XXH_PRIME1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t XXH_PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t XXH_PRIME3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t XXH_PRIME4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t XXH_PRIME5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotl64(uint64_t x, int r) {
+
+    return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t* p) {
+
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline uint64_t xxhRound(uint64_t acc, uint64_t input) {
+
+    acc += input * XXH_PRIME2;
+    acc = rotl64(acc, 31);
+    return acc * XXH_PRIME1;
+}
+
+static inline uint64_t xxhMerge(uint64_t acc, uint64_t v) {
+
+    acc ^= xxhRound(0, v);
+    return acc * XXH_PRIME1 + XXH_PRIME4;
+}
+
+static uint64_t xxHash64(const uint8_t* data, size_t size, uint64_t seed = 0) {
+
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+
+    uint64_t h = 0;
+
+    if (size >= 32) {
+
+        uint64_t v1 = seed + XXH_PRIME1 + XXH_PRIME2;
+        uint64_t v2 = seed + XXH_PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME1;
+
+        for (; p + 32 <= end; p += 32) {
+            v1 = xxhRound(v1, read64(p));
+            v2 = xxhRound(v2, read64(p + 8));
+            v3 = xxhRound(v3, read64(p + 16));
+            v4 = xxhRound(v4, read64(p + 24));
+        }
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = xxhMerge(h, v1);
+        h = xxhMerge(h, v2);
+        h = xxhMerge(h, v3);
+        h = xxhMerge(h, v4);
+    } else {
+        h = seed + XXH_PRIME5;
+    }
+
+    h += (uint64_t)size;
+
+    for (; p + 8 <= end; p += 8) {
+        h ^= xxhRound(0, read64(p));
+        h = rotl64(h, 27) * XXH_PRIME1 + XXH_PRIME4;
+    }
+
+    if (p + 4 <= end) {
+        uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        h ^= (uint64_t)v * XXH_PRIME1;
+        h = rotl64(h, 23) * XXH_PRIME2 + XXH_PRIME3;
+        p += 4;
+    }
+
+    for (; p < end; ++p) {
+        h ^= (uint64_t)(*p) * XXH_PRIME5;
+        h = rotl64(h, 11) * XXH_PRIME1;
+    }
+
+    h ^= h >> 33;
+    h *= XXH_PRIME2;
+    h ^= h >> 29;
+    h *= XXH_PRIME3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+// images are hashed in chunks of this size, which are processed in parallel
+static constexpr size_t HASH_CHUNK = 1 << 20;
+
+/**
+ * Hashes the chunks of an image on the thread pool and combines them.
+ * The chunks do not depend on the number of threads, neither does the hash.
+ */
+
+static uint64_t hashImage(const uint8_t* data, size_t size) {
+
+    size_t chunks = (size + HASH_CHUNK - 1) / HASH_CHUNK;
+
+    if (chunks <= 1) {
+        return xxHash64(data, size);
+    }
+
+    std::vector<uint64_t> hashes(chunks);
+
+    getThreadPool().parallelFor((int)chunks, [&](int c) {
+        size_t begin = c * HASH_CHUNK;
+        size_t end = std::min(size, begin + HASH_CHUNK);
+        hashes[c] = xxHash64(data + begin, end - begin);
+    });
+
+    return xxHash64((const uint8_t*)hashes.data(), chunks * sizeof(uint64_t));
+}
+
+/**
+ * Copies the rows of the region into the next pixel buffer and updates
+ * the texture from it. The unpack parameters must already be set.
+ */
+
+static void streamImage(CachedTexture& t,
+                        const ImageRect& r,
+                        const ImageInfo& i,
+                        const uint8_t* data,
+                        size_t rowBytes) {
+
+    size_t size = rowBytes * t.height;
+
+    if (t.stream == nullptr || t.stream->size != size) {
+        t.stream = std::make_unique<StreamBuffers>(size);
+        updateTextureBytes(t);
+        evictTextures();
+    }
+
+    StreamBuffers& sb = *t.stream;
+
+    int k = sb.next;
+    sb.next = (k + 1) % STREAM_BUFFERS;
+
+    // with three buffers this only waits if the gpu is frames behind
+
+    if (sb.fences[k] != nullptr) {
+        glClientWaitSync(sb.fences[k], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        glDeleteSync(sb.fences[k]);
+        sb.fences[k] = nullptr;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sb.pbos[k]);
+
+    size_t offset = rowBytes * r.y;
+    size_t bytes = rowBytes * r.height;
+
+    uint8_t* dst = (uint8_t*)sb.mapped[k];
+
+    if (dst != nullptr) {
+        dst += offset;
     } else {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        dst = (uint8_t*)glMapBufferRange(
+                GL_PIXEL_UNPACK_BUFFER,
+                offset,
+                bytes,
+                GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    if (dst != nullptr) {
+
+        ThreadPool& pool = getThreadPool();
+
+        int parts = (int)std::clamp(bytes / STREAM_COPY_PART, (size_t)1, pool.size() + 1);
+        size_t partSize = (bytes + parts - 1) / parts;
+
+        pool.parallelFor(parts, [&](int part) {
+            size_t begin = std::min(bytes, part * partSize);
+            size_t end = std::min(bytes, begin + partSize);
+            std::memcpy(dst + begin, data + offset + begin, end - begin);
+        });
+
+        if (sb.mapped[k] == nullptr) {
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        // the skip parameters address the region relative to the buffer
+
+        glTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                r.x,
+                r.y,
+                r.width,
+                r.height,
+                i.format,
+                i.datatype,
+                nullptr);
+
+        sb.fences[k] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+/**
+ * Uploads the image or its dirty region to the texture.
+ * Returns false if nothing had to be uploaded.
+ */
+
+static bool writeImage(CachedTexture& t,
+                       const ImageInfo& i,
+                       py::array& image,
+                       const ImageRect* dirty,
+                       bool stream) {
+
+    ImageRect r;
+    r.width = t.width;
+    r.height = t.height;
+
+    if (dirty != nullptr) {
+        r.x = std::clamp(dirty->x, 0, t.width);
+        r.y = std::clamp(dirty->y, 0, t.height);
+        r.width = std::clamp(dirty->width, 0, t.width - r.x);
+        r.height = std::clamp(dirty->height, 0, t.height - r.y);
+    }
+
+    if (r.width == 0 || r.height == 0) {
+        return false;
     }
 
     if (i.datatype == GL_UNSIGNED_BYTE) {
@@ -283,56 +830,376 @@ GLuint uploadImage(std::string id, ImageInfo& i, py::array& image, bool skip, bo
         image = array_like<float>::ensure(image);
     }
 
-    glTexImage2D(
-            GL_TEXTURE_2D,
-            0,
-            i.format,
-            i.imageWidth,
-            i.imageHeight,
-            0,
-            i.format,
-            i.datatype,
-            image.data());
+    // whole images are only uploaded if their content has changed,
+    // streams change every frame and dirty regions are given explicitly
 
-    glGenerateMipmap(GL_TEXTURE_2D);
+    if (dirty == nullptr && !stream) {
+
+        uint64_t hash = hashImage((const uint8_t*)image.data(), image.nbytes());
+
+        if (t.hasContentHash && t.contentHash == hash) {
+            return false;
+        }
+
+        t.hasContentHash = true;
+        t.contentHash = hash;
+    } else {
+        t.hasContentHash = false;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, t.id);
+
+    // the region is read from the rows of the whole image
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, t.width);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, r.x);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, r.y);
+
+    if (stream) {
+        size_t rowBytes = (size_t)t.width * i.channels * image.itemsize();
+        streamImage(t, r, i, (const uint8_t*)image.data(), rowBytes);
+    } else {
+        glTexSubImage2D(
+                GL_TEXTURE_2D,
+                0,
+                r.x,
+                r.y,
+                r.width,
+                r.height,
+                i.format,
+                i.datatype,
+                image.data());
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
 
     glBindTexture(GL_TEXTURE_2D, 0);
 
-    return textureId;
+    return true;
+}
+
+/**
+ * Sets the filters for display. Mipmaps are generated only if the texture
+ * is drawn minified, otherwise the min filter does not use them, so that
+ * outdated levels are never sampled.
+ */
+
+static void updateSampling(CachedTexture& t, bool lerp, bool minified) {
+
+    glBindTexture(GL_TEXTURE_2D, t.id);
+
+    if (minified && !t.mipmapsValid) {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        t.mipmapsValid = true;
+    }
+
+    GLint magFilter = lerp ? GL_LINEAR : GL_NEAREST;
+    GLint minFilter = magFilter;
+
+    if (minified) {
+        minFilter = lerp ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+    }
+
+    if (t.magFilter != magFilter) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter);
+        t.magFilter = magFilter;
+    }
+    if (t.minFilter != minFilter) {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+        t.minFilter = minFilter;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+ImVec2 textureDisplaySize(ImVec2 size, ImVec2 uv0, ImVec2 uv1) {
+
+    float uSpan = std::max(std::abs(uv1.x - uv0.x), 1e-6f);
+    float vSpan = std::max(std::abs(uv1.y - uv0.y), 1e-6f);
+
+    return ImVec2(std::abs(size.x) / uSpan, std::abs(size.y) / vSpan);
+}
+
+GLuint uploadImage(std::string id,
+                   ImageInfo& i,
+                   py::array& image,
+                   bool skip,
+                   bool lerp,
+                   const ImageRect* dirty,
+                   bool stream,
+                   ImVec2 displaySize,
+                   bool* uploaded) {
+
+    deleteRetiredTextures();
+
+    ImGuiID uniqueId = ImGui::GetID(id.c_str());
+
+    auto it = textureCache.find(uniqueId);
+
+    if (it == textureCache.end()) {
+        it = textureCache.emplace(uniqueId, CachedTexture()).first;
+        lruOrder.push_front(uniqueId);
+        it->second.lruPos = lruOrder.begin();
+    } else {
+        lruOrder.splice(lruOrder.begin(), lruOrder, it->second.lruPos);
+    }
+
+    CachedTexture& t = it->second;
+    t.lastFrame = ImGui::GetFrameCount();
+
+    GLenum internalFormat = sizedInternalFormat(i);
+
+    // create a texture if necessary, new storage must be filled completely
+
+    if (t.id == 0
+            || t.width != i.imageWidth
+            || t.height != i.imageHeight
+            || t.internalFormat != internalFormat) {
+
+        // keep the mipmaps, if they have been needed before
+        bool mipmaps = !stream && t.levels > 1;
+
+        allocateTexture(t, i, internalFormat, mipmaps);
+        evictTextures();
+
+        skip = false;
+        dirty = nullptr;
+    }
+
+    if (t.width == 0 || t.height == 0) {
+        return t.id;
+    }
+
+    // a texture drawn several times in a frame needs mipmaps if any of
+    // the draws is minified, streams and heatmaps never use them
+
+    ImVec2 scale = ImGui::GetIO().DisplayFramebufferScale;
+
+    bool minified = !stream
+        && displaySize.x > 0.0f
+        && displaySize.y > 0.0f
+        && (displaySize.x * scale.x < t.width || displaySize.y * scale.y < t.height);
+
+    if (minified && t.levels < mipLevels(t.width, t.height)) {
+
+        // textures start with a single level, the others are allocated
+        // once needed, which requires to upload the whole image again
+
+        allocateTexture(t, i, internalFormat, true);
+        evictTextures();
+
+        skip = false;
+        dirty = nullptr;
+    }
+
+    if (minified) {
+        t.minifiedFrame = t.lastFrame;
+    }
+
+    // upload texture
+
+    bool written = !skip && writeImage(t, i, image, dirty, stream);
+
+    if (written) {
+        t.mipmapsValid = false;
+    }
+
+    if (uploaded != nullptr) {
+        *uploaded = written;
+    }
+
+    // setup parameters for display
+
+    updateSampling(t, lerp, t.minifiedFrame == t.lastFrame);
+
+    return t.id;
+}
+
+static GLuint compileShader(GLenum type, const char* source) {
+
+    GLuint shader = glCreateShader(type);
+
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint success = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+
+    if (!success) {
+        char log[1024];
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        glDeleteShader(shader);
+        throw std::runtime_error(std::string("Shader compilation failed: ") + log);
+    }
+
+    return shader;
+}
+
+bool applyCallbackScissor(const ImDrawCmd* cmd) {
+
+    ImDrawData* drawData = ImGui::GetDrawData();
+    ImVec2 scale = drawData->FramebufferScale;
+
+    float fbHeight = drawData->DisplaySize.y * scale.y;
+
+    ImVec2 clipMin((cmd->ClipRect.x - drawData->DisplayPos.x) * scale.x,
+                   (cmd->ClipRect.y - drawData->DisplayPos.y) * scale.y);
+    ImVec2 clipMax((cmd->ClipRect.z - drawData->DisplayPos.x) * scale.x,
+                   (cmd->ClipRect.w - drawData->DisplayPos.y) * scale.y);
+
+    if (clipMax.x <= clipMin.x || clipMax.y <= clipMin.y) {
+        return false;
+    }
+
+    glScissor((int)clipMin.x,
+              (int)(fbHeight - clipMax.y),
+              (int)(clipMax.x - clipMin.x),
+              (int)(clipMax.y - clipMin.y));
+
+    return true;
+}
+
+GLuint compileShaderProgram(
+        const char* vertexSource,
+        const char* geometrySource,
+        const char* fragmentSource) {
+
+    GLuint program = glCreateProgram();
+
+    GLuint vertex = compileShader(GL_VERTEX_SHADER, vertexSource);
+    glAttachShader(program, vertex);
+
+    GLuint geometry = 0;
+    if (geometrySource != nullptr) {
+        geometry = compileShader(GL_GEOMETRY_SHADER, geometrySource);
+        glAttachShader(program, geometry);
+    }
+
+    GLuint fragment = compileShader(GL_FRAGMENT_SHADER, fragmentSource);
+    glAttachShader(program, fragment);
+
+    glLinkProgram(program);
+
+    // the shaders are kept alive by the program
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+    if (geometry != 0) {
+        glDeleteShader(geometry);
+    }
+
+    GLint success = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+
+    if (!success) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        glDeleteProgram(program);
+        throw std::runtime_error(std::string("Shader linking failed: ") + log);
+    }
+
+    return program;
+}
+
+PlotDataType interpretDataType(py::array& array) {
+
+    if (py::isinstance<py::array_t<double>>(array)) {
+        return PlotDataType::Float64;
+    } else if (py::isinstance<py::array_t<float>>(array)) {
+        return PlotDataType::Float32;
+    } else if (py::isinstance<py::array_t<ImS8>>(array)) {
+        return PlotDataType::Int8;
+    } else if (py::isinstance<py::array_t<ImU8>>(array)) {
+        return PlotDataType::UInt8;
+    } else if (py::isinstance<py::array_t<ImS16>>(array)) {
+        return PlotDataType::Int16;
+    } else if (py::isinstance<py::array_t<ImU16>>(array)) {
+        return PlotDataType::UInt16;
+    } else if (py::isinstance<py::array_t<ImS32>>(array)) {
+        return PlotDataType::Int32;
+    } else if (py::isinstance<py::array_t<ImU32>>(array)) {
+        return PlotDataType::UInt32;
+    } else if (py::isinstance<py::array_t<ImS64>>(array)) {
+        return PlotDataType::Int64;
+    } else if (py::isinstance<py::array_t<ImU64>>(array)) {
+        return PlotDataType::UInt64;
+    }
+
+    return PlotDataType::Unknown;
 }
 
 PlotArrayInfo interpretPlotArrays(
-        array_like<double>& x,
-        array_like<double>& y) {
+        py::array& x,
+        py::array& y,
+        double xScale,
+        double xStart) {
 
     PlotArrayInfo info;
 
     size_t yCount = y.shape()[0];
 
-    if (1 == x.ndim() && 0 == yCount) {
-        // one 1d array given
-        // assume x is [0, 1, 2, ..., N]
-        info.count = x.shape()[0];
-        info.indices.resize(info.count);
-        for (size_t i = 0; i < info.count; ++i) {
-            info.indices[i] = i;
+    // x and y are used in their native type and memory layout, if possible.
+    // Otherwise (differing or unsupported types) both are converted to double.
+
+    info.dataType = interpretDataType(x);
+
+    if (0 != yCount && interpretDataType(y) != info.dataType) {
+        info.dataType = PlotDataType::Unknown;
+    }
+    if (PlotDataType::Unknown == info.dataType) {
+        info.dataType = PlotDataType::Float64;
+    }
+
+    dispatchDataType(info.dataType, [&](auto tag) {
+        using T = decltype(tag);
+        info.xArray = array_view<T>::ensure(x);
+        if (0 != yCount) {
+            info.yArray = array_view<T>::ensure(y);
         }
-        info.xDataPtr = info.indices.data();
-        info.yDataPtr = x.data();
-    } else if (2 == x.ndim() && 0 == yCount) {
+    });
+
+    if (!info.xArray || (0 != yCount && !info.yArray)) {
+        throw std::runtime_error(
+                "Plot data with x-dtype "
+                + std::string(py::str(x.dtype()))
+                + " and y-dtype "
+                + std::string(py::str(y.dtype()))
+                + " cannot be converted to numbers");
+    }
+
+    py::array& xa = info.xArray;
+    py::array& ya = info.yArray;
+
+    if (1 == xa.ndim() && 0 == yCount) {
+        // one 1d array given
+        // assume x is [0, 1, 2, ..., N] * xScale + xStart
+        info.count = xa.shape()[0];
+        info.implicitX = true;
+        info.monotonicX = true;
+        info.xScale = xScale;
+        info.xStart = xStart;
+        info.yDataPtr = xa.data();
+        info.yStride = xa.strides(0);
+    } else if (2 == xa.ndim() && 0 == yCount) {
         // one 2d array given
-        size_t len0 = x.shape()[0];
-        size_t len1 = x.shape()[1];
+        size_t len0 = xa.shape()[0];
+        size_t len1 = xa.shape()[1];
         if (len0 == 2) {
-            info.xDataPtr = x.data();
-            info.yDataPtr = x.data() + len1;
+            info.xDataPtr = xa.data();
+            info.yDataPtr = xa.data(1);
+            info.xStride = xa.strides(1);
+            info.yStride = xa.strides(1);
             info.count = len1;
         }
-    } else if (1 == x.ndim() && 1 == y.ndim()) {
+    } else if (1 == xa.ndim() && 1 == ya.ndim()) {
         // two 2d arrays given
-        info.count = std::min(x.shape()[0], y.shape()[0]);
-        info.xDataPtr = x.data();
-        info.yDataPtr = y.data();
+        info.count = std::min(xa.shape()[0], ya.shape()[0]);
+        info.xDataPtr = xa.data();
+        info.yDataPtr = ya.data();
+        info.xStride = xa.strides(0);
+        info.yStride = ya.strides(0);
     } else {
         throw std::runtime_error(
                 "Plot data with x-shape "
@@ -344,3 +1211,234 @@ PlotArrayInfo interpretPlotArrays(
 
     return info;
 }
+
+PlotArrayInfo interpretPlotRows(
+        py::array& x,
+        py::array& ys,
+        ptrdiff_t& rowStride,
+        double xScale,
+        double xStart) {
+
+    assert_shape(ys, {{-1, -1}});
+
+    PlotArrayInfo info;
+
+    bool hasX = 0 != x.size();
+
+    // same type rules as in interpretPlotArrays
+
+    info.dataType = interpretDataType(ys);
+
+    if (hasX && interpretDataType(x) != info.dataType) {
+        info.dataType = PlotDataType::Unknown;
+    }
+    if (PlotDataType::Unknown == info.dataType) {
+        info.dataType = PlotDataType::Float64;
+    }
+
+    dispatchDataType(info.dataType, [&](auto tag) {
+        using T = decltype(tag);
+        info.yArray = array_view<T>::ensure(ys);
+        if (hasX) {
+            info.xArray = array_view<T>::ensure(x);
+        }
+    });
+
+    if (!info.yArray || (hasX && !info.xArray)) {
+        throw std::runtime_error(
+                "Plot data with x-dtype "
+                + std::string(py::str(x.dtype()))
+                + " and y-dtype "
+                + std::string(py::str(ys.dtype()))
+                + " cannot be converted to numbers");
+    }
+
+    py::array& ya = info.yArray;
+
+    info.count = ya.shape(1);
+    info.yDataPtr = ya.data();
+    info.yStride = ya.strides(1);
+
+    rowStride = ya.strides(0);
+
+    if (hasX) {
+        py::array& xa = info.xArray;
+        assert_shape(xa, {{-1}});
+        info.count = std::min(info.count, (size_t)xa.shape(0));
+        info.xDataPtr = xa.data();
+        info.xStride = xa.strides(0);
+    } else {
+        info.implicitX = true;
+        info.monotonicX = true;
+        info.xScale = xScale;
+        info.xStart = xStart;
+    }
+
+    return info;
+}
+
+PlotBandInfo interpretPlotBand(
+        py::array& shade,
+        py::array& lower,
+        py::array& upper) {
+
+    PlotBandInfo info;
+
+    if (0 != shade.size()) {
+
+        py::array sa = array_view<double>::ensure(shade);
+
+        if (!sa) {
+            throw std::runtime_error("Shade cannot be converted to numbers");
+        }
+
+        assert_shape(sa, {{-1}, {2, -1}});
+
+        info.lowerArray = sa;
+        info.upperArray = sa;
+        info.relative = true;
+
+        if (1 == sa.ndim()) {
+            info.count = sa.shape(0);
+            info.lowerDataPtr = sa.data();
+            info.upperDataPtr = sa.data();
+            info.lowerStride = sa.strides(0);
+            info.upperStride = sa.strides(0);
+        } else {
+            info.count = sa.shape(1);
+            info.lowerDataPtr = sa.data(0);
+            info.upperDataPtr = sa.data(1);
+            info.lowerStride = sa.strides(1);
+            info.upperStride = sa.strides(1);
+        }
+
+    } else if (0 != lower.size() || 0 != upper.size()) {
+
+        if (0 == lower.size() || 0 == upper.size()) {
+            throw py::value_error("Band bounds lower and upper must be given together");
+        }
+
+        info.lowerArray = array_view<double>::ensure(lower);
+        info.upperArray = array_view<double>::ensure(upper);
+
+        if (!info.lowerArray || !info.upperArray) {
+            throw std::runtime_error("Band bounds cannot be converted to numbers");
+        }
+
+        assert_shape(info.lowerArray, {{-1}});
+        assert_shape(info.upperArray, {{-1}});
+
+        info.relative = false;
+        info.count = std::min(info.lowerArray.shape(0), info.upperArray.shape(0));
+        info.lowerDataPtr = info.lowerArray.data();
+        info.upperDataPtr = info.upperArray.data();
+        info.lowerStride = info.lowerArray.strides(0);
+        info.upperStride = info.upperArray.strides(0);
+    }
+
+    return info;
+}
+
+PlotColorInfo interpretPointColors(
+        py::handle color,
+        py::array& values,
+        ImPlotColormap colormap,
+        ImPlotRange range) {
+
+    PlotColorInfo info;
+
+    if (0 != values.size()) {
+
+        assert_shape(values, {{-1}});
+
+        info.type = PlotColorType::Mapped;
+        info.valueType = interpretDataType(values);
+
+        if (PlotDataType::Unknown == info.valueType) {
+            info.valueType = PlotDataType::Float64;
+        }
+
+        dispatchDataType(info.valueType, [&](auto tag) {
+            using T = decltype(tag);
+            info.array = array_view<T>::ensure(values);
+        });
+
+        if (!info.array) {
+            throw std::runtime_error("Color values cannot be converted to numbers");
+        }
+
+        info.dataPtr = info.array.data();
+        info.stride = info.array.strides(0);
+        info.count = info.array.shape(0);
+        info.colormap = colormap;
+
+        if (range.Min == range.Max) {
+            // use the value range of the finite data
+            range = ImPlotRange(HUGE_VAL, -HUGE_VAL);
+            dispatchDataType(info.valueType, [&](auto tag) {
+                using T = decltype(tag);
+                extendFiniteRange<T>(range, info.dataPtr, info.count, info.stride);
+            });
+            if (range.Min > range.Max) {
+                range = ImPlotRange(0.0, 1.0);
+            }
+        }
+
+        info.valueMin = range.Min;
+        info.valueMax = range.Max;
+
+        return info;
+    }
+
+    py::array colorArray;
+
+    if (py::isinstance<py::array>(color)) {
+        colorArray = py::reinterpret_borrow<py::array>(color);
+    } else if (py::isinstance<py::list>(color) || py::isinstance<py::tuple>(color)) {
+        // nested sequences may be per-point colors as well
+        colorArray = py::array::ensure(color);
+        if (!colorArray) {
+            return info;
+        }
+    } else {
+        return info;
+    }
+
+    if (1 == colorArray.ndim()
+            && py::isinstance<py::array_t<uint32_t>>(colorArray)) {
+
+        // packed rgba values
+        info.type = PlotColorType::Packed;
+        info.array = colorArray;
+        info.stride = colorArray.strides(0);
+
+    } else if (2 == colorArray.ndim()
+            && 4 == colorArray.shape(1)
+            && py::isinstance<py::array_t<uint8_t>>(colorArray)) {
+
+        // rows of rgba bytes have the same memory layout as packed colors
+        info.type = PlotColorType::Packed;
+        if (1 == colorArray.strides(1)) {
+            info.array = colorArray;
+        } else {
+            info.array = array_like<uint8_t>::ensure(colorArray);
+        }
+        info.stride = info.array.strides(0);
+
+    } else if (2 == colorArray.ndim()) {
+
+        assert_shape(colorArray, {{-1, 4}});
+
+        info.type = PlotColorType::Float4;
+        info.array = array_like<float>::ensure(colorArray);
+        info.stride = 4 * sizeof(float);
+
+    } else {
+        return info;
+    }
+
+    info.dataPtr = info.array.data();
+    info.count = info.array.shape(0);
+
+    return info;
+}
@@ -7,7 +7,10 @@
 
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <type_traits>
 
 namespace py = pybind11;
 
@@ -18,6 +21,21 @@ namespace py = pybind11;
 template <typename T>
 using array_like = py::array_t<T, py::array::c_style | py::array::forcecast>;
 
+/**
+ * Like array_like, but keeps the memory layout (strides) of the input.
+ * Views into other arrays are therefore not copied.
+ */
+
+template <typename T>
+using array_view = py::array_t<T, py::array::forcecast>;
+
+/**
+ * Returns arrays as they are. Other objects, like lists or scalars, are
+ * converted by numpy, scalars to arrays of one element.
+ */
+
+py::array asArray(py::handle obj);
+
 std::string shapeToStr(py::array& array);
 
 void assertArrayShape(std::string name,
@@ -35,23 +53,355 @@ struct ImageInfo {
     int channels = 0;
     GLenum format = 0;
     GLenum datatype = 0;
+
+    // storage format of the texture, zero means 8 bits per channel of
+    // format, also for float data
+    GLenum internalFormat = 0;
+};
+
+/**
+ * A region of an image in pixels.
+ */
+
+struct ImageRect {
+
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
 };
 
 ImageInfo interpretImage(py::array& image);
 
-GLuint uploadImage(std::string id, ImageInfo& i, py::array& image, bool skip = false, bool lerp = false);
+/**
+ * Converts an (x, y, width, height) sequence. Returns false for None.
+ */
+
+bool interpretImageRect(py::handle& rect, ImageRect& r);
+
+/**
+ * The size in pixels, at which a whole texture is drawn, if its region
+ * between uv0 and uv1 is drawn at the given size.
+ */
+
+ImVec2 textureDisplaySize(ImVec2 size, ImVec2 uv0, ImVec2 uv1);
+
+/**
+ * Uploads an image to the texture cached for the given id.
+ *
+ * The storage of a texture is immutable and only allocated again if the
+ * size or format of the image changes. Otherwise the image is copied into
+ * the existing storage, or only its dirty region if one is given.
+ *
+ * Streamed images are copied into pixel buffers first, so that the driver
+ * transfers them asynchronously instead of stalling the frame.
+ *
+ * Whole, non-streamed images are hashed and not uploaded again if their
+ * content is unchanged, so skip is only needed to avoid the hashing.
+ *
+ * displaySize is the size in pixels, at which the whole texture is drawn.
+ * Mipmaps are only allocated and generated if it is smaller than the
+ * image. Streamed textures and those of unknown display size (zero)
+ * never get mipmaps.
+ *
+ * If given, uploaded is set to whether new content has been written.
+ * The image is then converted to the type of the texture in place.
+ */
+
+GLuint uploadImage(std::string id,
+                   ImageInfo& i,
+                   py::array& image,
+                   bool skip = false,
+                   bool lerp = false,
+                   const ImageRect* dirty = nullptr,
+                   bool stream = false,
+                   ImVec2 displaySize = ImVec2(0.0f, 0.0f),
+                   bool* uploaded = nullptr);
+
+/**
+ * The textures of uploadImage are cached per id. Once their memory
+ * exceeds the budget, the least recently used ones are deleted, except
+ * for those used in the current frame. A budget of zero disables this.
+ */
+
+constexpr size_t DEFAULT_TEXTURE_BUDGET = (size_t)1 << 30;
+
+struct TextureCacheStats {
+
+    size_t textures = 0;
+    size_t bytes = 0;
+    size_t budget = 0;
+    size_t evictions = 0;
+};
+
+void setTextureBudget(size_t bytes);
+
+TextureCacheStats getTextureCacheStats();
+
+/**
+ * Sets the scissor rect for an ImDrawList callback, which the backend
+ * does not do itself. Returns false if the clip rect is empty.
+ */
+
+bool applyCallbackScissor(const ImDrawCmd* cmd);
+
+/**
+ * Compiles and links a shader program, the geometry shader is optional.
+ * Throws a runtime error containing the info log on failure.
+ */
+
+GLuint compileShaderProgram(
+        const char* vertexSource,
+        const char* geometrySource,
+        const char* fragmentSource);
+
+/**
+ * Element types, which can be plotted directly without prior conversion.
+ */
+
+enum class PlotDataType {
+    Unknown,
+    Int8,
+    UInt8,
+    Int16,
+    UInt16,
+    Int32,
+    UInt32,
+    Int64,
+    UInt64,
+    Float32,
+    Float64
+};
+
+PlotDataType interpretDataType(py::array& array);
+
+/**
+ * Calls func with a value of the C++ type matching the given data type.
+ * Unknown types are mapped to double.
+ *
+ * Note: the ImGui integer typedefs are used, because implot only
+ * instantiates its templated plotting functions for those.
+ */
+
+template <typename F>
+void dispatchDataType(PlotDataType type, F&& func) {
+
+    switch (type) {
+        case PlotDataType::Int8: func(ImS8()); break;
+        case PlotDataType::UInt8: func(ImU8()); break;
+        case PlotDataType::Int16: func(ImS16()); break;
+        case PlotDataType::UInt16: func(ImU16()); break;
+        case PlotDataType::Int32: func(ImS32()); break;
+        case PlotDataType::UInt32: func(ImU32()); break;
+        case PlotDataType::Int64: func(ImS64()); break;
+        case PlotDataType::UInt64: func(ImU64()); break;
+        case PlotDataType::Float32: func(float()); break;
+        default: func(double()); break;
+    }
+}
+
+/**
+ * Integers are always finite. Floats are checked by their exponent bits,
+ * since comparisons with NaN are optimized away with -ffast-math.
+ */
+
+template <typename T>
+inline bool isFiniteValue(T v) {
+
+    if constexpr (std::is_same_v<T, float>) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return (bits & 0x7f800000u) != 0x7f800000u;
+    } else if constexpr (std::is_same_v<T, double>) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        return (bits & 0x7ff0000000000000ull) != 0x7ff0000000000000ull;
+    } else {
+        return true;
+    }
+}
+
+/**
+ * Extends range by the finite values of a strided array.
+ *
+ * The loop body has no branches, so that it is vectorized for contiguous
+ * arrays. An empty range is given by Min > Max.
+ */
+
+template <typename T>
+void extendFiniteRange(ImPlotRange& range,
+                       const void* data,
+                       size_t count,
+                       ptrdiff_t stride) {
+
+    const uint8_t* ptr = (const uint8_t*)data;
+
+    double lo = range.Min;
+    double hi = range.Max;
+
+    if (stride == (ptrdiff_t)sizeof(T)) {
+        const T* values = (const T*)ptr;
+        for (size_t i = 0; i < count; ++i) {
+            bool finite = isFiniteValue(values[i]);
+            double v = (double)values[i];
+            lo = finite && v < lo ? v : lo;
+            hi = finite && v > hi ? v : hi;
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            T value = *(const T*)(ptr + (ptrdiff_t)i * stride);
+            bool finite = isFiniteValue(value);
+            double v = (double)value;
+            lo = finite && v < lo ? v : lo;
+            hi = finite && v > hi ? v : hi;
+        }
+    }
+
+    range.Min = lo;
+    range.Max = hi;
+}
 
 struct PlotArrayInfo {
 
-    std::vector<double> indices;
-    const double* xDataPtr = nullptr;
-    const double* yDataPtr = nullptr;
+    // keeps the (possibly converted) input arrays alive
+    py::array xArray;
+    py::array yArray;
+
+    PlotDataType dataType = PlotDataType::Float64;
+
+    // point to the first element, strides are given in bytes
+    const void* xDataPtr = nullptr;
+    const void* yDataPtr = nullptr;
+    ptrdiff_t xStride = 0;
+    ptrdiff_t yStride = 0;
+
+    // if set, x is not stored but given as xStart + xScale * index
+    bool implicitX = false;
+    double xScale = 1.0;
+    double xStart = 0.0;
+
+    // allows culling of invisible points via binary search
+    bool monotonicX = false;
+
+    // if set, the data is a ring buffer with the given capacity,
+    // which starts at ringOffset and wraps around at the end
+    size_t ringOffset = 0;
+    size_t ringCapacity = 0;
+
     size_t count = 0;
+
+    // if set, bounds holds the range of the finite values, so that
+    // fitting does not need to visit every point (see RingBuffer)
+    bool hasBounds = false;
+    ImPlotRect bounds;
+
+    // if set, all values are known to be finite, so that line plots
+    // do not need to search for NaN gaps
+    bool finite = false;
 };
 
 PlotArrayInfo interpretPlotArrays(
-        array_like<double>& x,
-        array_like<double>& y);
+        py::array& x,
+        py::array& y,
+        double xScale = 1.0,
+        double xStart = 0.0);
+
+/**
+ * Per-point colors of a plot, which are converted to packed ImU32 colors
+ * only for the points actually drawn.
+ *
+ * Float4: (N, 4) float rgba values in [0, 1]
+ * Packed: (N,) uint32 or (N, 4) uint8 rgba values, used without conversion
+ * Mapped: (N,) scalar values, mapped to colors by a colormap lookup table,
+ *         non-finite values are transparent
+ */
+
+enum class PlotColorType {
+    None,
+    Float4,
+    Packed,
+    Mapped
+};
+
+struct PlotColorInfo {
+
+    // keeps the (possibly converted) input array alive
+    py::array array;
+
+    PlotColorType type = PlotColorType::None;
+
+    // point to the first element, strides are given in bytes
+    const void* dataPtr = nullptr;
+    ptrdiff_t stride = 0;
+
+    // only used for mapped colors
+    PlotDataType valueType = PlotDataType::Float64;
+    ImPlotColormap colormap = IMPLOT_AUTO;
+    double valueMin = 0.0;
+    double valueMax = 1.0;
+
+    size_t count = 0;
+};
+
+/**
+ * Interprets color as per-point colors or, if given, the values as
+ * scalars to be mapped with the colormap. If the range is empty, the
+ * minimum and maximum of the finite values are used. Returns type None
+ * if color is a single color.
+ */
+
+PlotColorInfo interpretPointColors(
+        py::handle color,
+        py::array& values,
+        ImPlotColormap colormap = IMPLOT_AUTO,
+        ImPlotRange range = ImPlotRange(0.0, 0.0));
+
+/**
+ * Bounds of a shaded band, which are either given relative to the
+ * y-values of a plot (y - lower, y + upper) or as absolute values.
+ */
+
+struct PlotBandInfo {
+
+    // keeps the (possibly converted) input arrays alive
+    py::array lowerArray;
+    py::array upperArray;
+
+    // point to the first element, strides are given in bytes
+    const void* lowerDataPtr = nullptr;
+    const void* upperDataPtr = nullptr;
+    ptrdiff_t lowerStride = 0;
+    ptrdiff_t upperStride = 0;
+
+    bool relative = true;
+
+    size_t count = 0;
+};
+
+/**
+ * Shade is either a 1d array of symmetric offsets or a (2, N) array
+ * of lower and upper offsets. Alternatively, absolute lower and upper
+ * bounds can be given, which are required both. The count is zero if
+ * no band is given.
+ */
+
+PlotBandInfo interpretPlotBand(
+        py::array& shade,
+        py::array& lower,
+        py::array& upper);
+
+/**
+ * Interprets the rows of a 2d array as y-values, which share x.
+ * The returned info describes the first row, the following rows
+ * are found by advancing yDataPtr by rowStride bytes.
+ */
+
+PlotArrayInfo interpretPlotRows(
+        py::array& x,
+        py::array& ys,
+        ptrdiff_t& rowStride,
+        double xScale = 1.0,
+        double xStart = 0.0);
 
 /*
  * Custom type-casters
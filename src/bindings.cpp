@@ -436,25 +436,40 @@ PYBIND11_MODULE(cppimviz, m) {
         glGetTexLevelParameteriv(GL_TEXTURE_2D, 0,
                                  GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
 
+        // textures are stored in sized formats, which are read back
+        // as their base format
+
         GLint d = 0;
-        if (internalFormat == GL_RED) {
+        GLenum format = 0;
+        if (internalFormat == GL_RED
+                || internalFormat == GL_R8
+                || internalFormat == GL_R32F) {
             d = 1;
-        } else if (internalFormat == GL_RGB) {
+            format = GL_RED;
+        } else if (internalFormat == GL_RGB
+                || internalFormat == GL_RGB8
+                || internalFormat == GL_RGB32F) {
             d = 3;
-        } else if (internalFormat == GL_RGBA) {
+            format = GL_RGB;
+        } else if (internalFormat == GL_RGBA
+                || internalFormat == GL_RGBA8
+                || internalFormat == GL_RGBA32F) {
             d = 4;
+            format = GL_RGBA;
         } else {
             throw std::runtime_error("Unknown internal texture format!");
         }
 
-        py::array_t<uint8_t> pixels({w, h, d});
+        py::array_t<uint8_t> pixels({h, w, d});
 
         glGetTexImage(GL_TEXTURE_2D,
                       0,
-                      internalFormat,
+                      format,
                       GL_UNSIGNED_BYTE,
                       (void*)pixels.mutable_data(0));
 
+        glBindTexture(GL_TEXTURE_2D, 0);
+
         return pixels;
     },
     R"raw(
@@ -464,7 +479,31 @@ PYBIND11_MODULE(cppimviz, m) {
     with shape (height, width, channels)
 
     The number of channels depends on the internal format of the texture.
-    GL_RED: 1, GL_RGB: 3, GL_RGBA: 4, else: runtime_error
+    GL_RED, GL_R8, GL_R32F: 1, GL_RGB, GL_RGB8, GL_RGB32F: 3,
+    GL_RGBA, GL_RGBA8, GL_RGBA32F: 4, else: runtime_error
     )raw",
     py::arg("texture_id") = 0);
+
+    py::class_<TextureCacheStats>(m, "TextureCacheStats")
+        .def_readonly("textures", &TextureCacheStats::textures)
+        .def_readonly("bytes", &TextureCacheStats::bytes)
+        .def_readonly("budget", &TextureCacheStats::budget)
+        .def_readonly("evictions", &TextureCacheStats::evictions);
+
+    m.def("set_texture_budget", &setTextureBudget,
+    R"raw(
+    Sets the gpu memory in bytes, which the cached image textures may use.
+
+    Once the budget is exceeded, the least recently used textures are
+    deleted. Textures used in the current frame are always kept.
+    Texture ids of deleted images must not be used anymore.
+    A budget of zero disables the eviction.
+    )raw",
+    py::arg("bytes") = DEFAULT_TEXTURE_BUDGET);
+
+    m.def("get_texture_cache_stats", &getTextureCacheStats,
+    R"raw(
+    Returns the number of cached image textures, their estimated gpu
+    memory in bytes, the budget and the number of evicted textures.
+    )raw");
 }
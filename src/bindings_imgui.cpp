@@ -692,10 +692,15 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
                 int displayWidth,
                 int displayHeight,
                 array_like<double> tint,
-                array_like<double> borderCol) {
+                array_like<double> borderCol,
+                py::handle dirtyRect,
+                bool stream) {
 
         ImageInfo info = interpretImage(image);
 
+        ImageRect dirty;
+        bool hasDirty = interpretImageRect(dirtyRect, dirty);
+
         if (displayWidth < 0) {
             displayWidth = info.imageWidth;
         }
@@ -725,7 +730,14 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
         if (ImGui::IsRectVisible(bb.Min, bb.Max)) {
             // only upload the image to gpu, if it's actually visible
             // this improves performance for e.g. large lists of images
-            textureId = uploadImage(id, info, image);
+            textureId = uploadImage(id,
+                                    info,
+                                    image,
+                                    false,
+                                    false,
+                                    hasDirty ? &dirty : nullptr,
+                                    stream,
+                                    size);
         }
 
         ImGui::Image((void*)(intptr_t)textureId,
@@ -740,7 +752,9 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
     py::arg("width") = -1,
     py::arg("height") = -1,
     py::arg("tint") = py::array(),
-    py::arg("border_col") = py::array());
+    py::arg("border_col") = py::array(),
+    py::arg("dirty_rect") = py::none(),
+    py::arg("stream") = false);
 
     m.def("image_texture", [&](
                 GLuint textureId,
@@ -1412,7 +1426,11 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
             }
         }
 
-        void applyTransform(size_t startIndex) {
+        /**
+         * Transforms the vertices added since vtxStart, which is an
+         * index into the vertex buffer (not a draw index).
+         */
+        void applyTransform(int vtxStart) {
 
             if (trafoStack.size() == 0) {
                 return;
@@ -1420,10 +1438,10 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
 
             const VizMatrix& m = trafoStack.back();
 
-            if (startIndex < dl._VtxCurrentIdx)
+            if (vtxStart < dl.VtxBuffer.Size)
             {
-                ImDrawVert* const vertexBegin = dl.VtxBuffer.Data + startIndex;
-                ImDrawVert* const vertexEnd   = dl.VtxBuffer.Data + dl._VtxCurrentIdx;
+                ImDrawVert* const vertexBegin = dl.VtxBuffer.Data + vtxStart;
+                ImDrawVert* const vertexEnd   = dl.VtxBuffer.Data + dl.VtxBuffer.Size;
 
                 for (ImDrawVert* vertex = vertexBegin; vertex != vertexEnd; ++vertex)
                 {
@@ -1470,10 +1488,13 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
             ImU32 col = ImGui::GetColorU32(interpretColor(color));
 
             ImVec2 uv(dl._Data->TexUvWhitePixel);
-            ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+            int vtxStart = dl.VtxBuffer.Size;
 
             dl.PrimReserve(count, count);
 
+            // the reservation may have started a new command with a vertex offset
+            ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+
             for (size_t i = 0; i < count; ++i) {
                 dl._IdxWritePtr[i] = (ImDrawIdx)(idx+i);
                 dl._VtxWritePtr[i].pos.x = vertices.at(i, 0);
@@ -1486,7 +1507,7 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
             dl._VtxCurrentIdx += count;
             dl._IdxWritePtr += count;
 
-            applyTransform(idx);
+            applyTransform(vtxStart);
         }
 
         void addLine(const ImVec2& p0, const ImVec2& p1, py::handle& color, float width) {
@@ -1504,10 +1525,12 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
             const ImVec2& d = p1 + dir*half_width - ortho*half_width;
 
             ImVec2 uv(dl._Data->TexUvWhitePixel);
-            ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+            int vtxStart = dl.VtxBuffer.Size;
 
             dl.PrimReserve(6, 4);
 
+            ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+
             dl._IdxWritePtr[0] = idx;
             dl._IdxWritePtr[1] = (ImDrawIdx)(idx+1);
             dl._IdxWritePtr[2] = (ImDrawIdx)(idx+2);
@@ -1533,7 +1556,7 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
             dl._VtxCurrentIdx += 4;
             dl._IdxWritePtr += 6;
 
-            applyTransform(idx);
+            applyTransform(vtxStart);
         }
 
         void addRect(const ImVec2& p_min,
@@ -1552,10 +1575,12 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
                 const ImVec2& c = p_max;
 
                 ImVec2 b(c.x, a.y), d(a.x, c.y), uv(dl._Data->TexUvWhitePixel);
-                ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+                int vtxStart = dl.VtxBuffer.Size;
 
                 dl.PrimReserve(6, 4);
 
+                ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+
                 dl._IdxWritePtr[0] = idx;
                 dl._IdxWritePtr[1] = (ImDrawIdx)(idx+1);
                 dl._IdxWritePtr[2] = (ImDrawIdx)(idx+2);
@@ -1581,7 +1606,7 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
                 dl._VtxCurrentIdx += 4;
                 dl._IdxWritePtr += 6;
 
-                applyTransform(idx);
+                applyTransform(vtxStart);
             }
 
             ImVec4 lineCol = interpretColor(lineColor);
@@ -1603,10 +1628,12 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
                 const ImVec2 id(ia.x, ic.y);
 
                 ImVec2 uv(dl._Data->TexUvWhitePixel);
-                ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+                int vtxStart = dl.VtxBuffer.Size;
 
                 dl.PrimReserve(24, 8);
 
+                ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+
                 dl._IdxWritePtr[0] = idx;
                 dl._IdxWritePtr[1] = (ImDrawIdx)(idx+4);
                 dl._IdxWritePtr[2] = (ImDrawIdx)(idx+1);
@@ -1661,7 +1688,7 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
                 dl._VtxCurrentIdx += 8;
                 dl._IdxWritePtr += 24;
 
-                applyTransform(idx);
+                applyTransform(vtxStart);
             }
         }
 
@@ -1679,16 +1706,24 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
             }
 
             ImageInfo info = interpretImage(image);
-            GLuint textureId = uploadImage(label, info, image);
-
-            unsigned int startIndex = dl._VtxCurrentIdx;
+            GLuint textureId = uploadImage(
+                    label,
+                    info,
+                    image,
+                    false,
+                    false,
+                    nullptr,
+                    false,
+                    textureDisplaySize(pMax - pMin, uvMin, uvMax));
+
+            int vtxStart = dl.VtxBuffer.Size;
             dl.AddImage((void*)(intptr_t)textureId,
                         pMin,
                         pMax,
                         uvMin,
                         uvMax,
                         c);
-            applyTransform(startIndex);
+            applyTransform(vtxStart);
         }
 
         void addBaseNgon(const ImVec2& c,
@@ -1713,11 +1748,13 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
 
             if (fillCol.w != -1) {
 
-                ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+                int vtxStart = dl.VtxBuffer.Size;
                 ImU32 col = ImGui::GetColorU32(fillCol);
 
                 dl.PrimReserve(3*numSegments, 1+numSegments);
 
+                ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+
                 // center vertex
                 dl._VtxWritePtr[0].pos = c;
                 dl._VtxWritePtr[0].uv = uv;
@@ -1749,18 +1786,20 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
                 dl._VtxCurrentIdx += numSegments+1;
                 dl._IdxWritePtr += 3*numSegments;
 
-                applyTransform(idx);
+                applyTransform(vtxStart);
             }
 
             ImVec4 lineCol = interpretColor(lineColor);
 
             if (lineCol.w != -1 && lineWidth > 0) {
 
-                ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+                int vtxStart = dl.VtxBuffer.Size;
                 ImU32 col = ImGui::GetColorU32(lineCol);
 
                 dl.PrimReserve(3*2*numSegments, 2*numSegments);
 
+                ImDrawIdx idx = (ImDrawIdx)dl._VtxCurrentIdx;
+
                 double ai = a - lineWidth*0.5;
                 double ao = a + lineWidth*0.5;
                 double bi = b - lineWidth*0.5;
@@ -1809,7 +1848,7 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
                 dl._VtxCurrentIdx += 2*numSegments;
                 dl._IdxWritePtr += 3*2*numSegments;
 
-                applyTransform(idx);
+                applyTransform(vtxStart);
             }
         }
 
@@ -1817,7 +1856,7 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
                      std::string text,
                      array_like<double> color) {
 
-            unsigned int startIndex = dl._VtxCurrentIdx;
+            int vtxStart = dl.VtxBuffer.Size;
 
             double x = trafoStack.back().m20;
             double y = trafoStack.back().m21;
@@ -1828,7 +1867,7 @@ void loadImguiPythonBindings(pybind11::module& m, ImViz& viz) {
 
             //dl.AddText(NULL, 0.0f, position, col, text_begin, text_end);
 
-            applyTransform(startIndex);
+            applyTransform(vtxStart);
         }
     };
 
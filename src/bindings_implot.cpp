@@ -4,7 +4,9 @@
 #include "imviz.hpp"
 
 #define _USE_MATH_DEFINES
+#include <array>
 #include <cmath>
+#include <optional>
 
 #include <pybind11/pytypes.h>
 #include <pybind11/stl.h>
@@ -13,8 +15,244 @@
 #include "implot.h"
 #include "implot_internal.h"
 #include "implot_ext.hpp"
+#include "plot_heatmap.hpp"
+#include "plot_histogram.hpp"
+#include "plot_kernels.hpp"
+#include "plot_series.hpp"
+#include "ring_buffer.hpp"
 
 
+/**
+ * Line and marker style as given by matplotlib like format strings.
+ */
+
+struct PlotFormat {
+    bool line = false;
+    ImPlotMarker marker = ImPlotMarker_None;
+};
+
+static PlotFormat parsePlotFormat(const std::string& fmt) {
+
+    static std::regex re{"(-)?(o|s|d|\\*|\\+)?"};
+
+    std::smatch match;
+    std::regex_search(fmt, match, re);
+
+    std::vector<std::string> groups;
+    for (auto m : match) {
+        if (m.matched) {
+            groups.push_back(m.str());
+        } else {
+            groups.push_back("");
+        }
+    }
+
+    PlotFormat pf;
+
+    pf.line = groups[1] == "-";
+
+    if (groups[2] == "o") {
+        pf.marker = ImPlotMarker_Circle;
+    } else if (groups[2] == "s") {
+        pf.marker = ImPlotMarker_Square;
+    } else if (groups[2] == "d") {
+        pf.marker = ImPlotMarker_Diamond;
+    } else if (groups[2] == "+") {
+        pf.marker = ImPlotMarker_Cross;
+    } else if (groups[2] == "*") {
+        pf.marker = ImPlotMarker_Asterisk;
+    }
+
+    return pf;
+}
+
+/**
+ * Plot style, which is parsed once and can then be reused for many items.
+ */
+
+struct PlotStyle {
+
+    std::string fmt = "-";
+    PlotFormat format = {true, ImPlotMarker_None};
+
+    py::object colorHandle = py::none();
+    ImVec4 color = IMPLOT_AUTO_COL;
+
+    float lineWeight = 1.0f;
+    float markerSize = 4.0f;
+    float markerWeight = 1.0f;
+    float shadeAlpha = 0.3f;
+
+    // only used for items drawn as lines, unless flags are given explicitly
+    ImPlotLineFlags flags = ImPlotLineFlags_None;
+
+    void setFmt(const std::string& f) {
+        fmt = f;
+        format = parsePlotFormat(f);
+    }
+
+    void setColor(py::handle c) {
+        bool isArray = false;
+        ImVec4 ic = interpretColor(c, &isArray);
+        if (isArray) {
+            throw py::value_error("PlotStyle does not support per-point colors");
+        }
+        colorHandle = py::reinterpret_borrow<py::object>(c);
+        color = ic;
+    }
+
+    // an explicit color takes precedence over the one of the style
+    ImVec4 resolveColor(const ImVec4& c) const {
+        return c.w >= 0.0f ? c : color;
+    }
+
+    void apply(const ImVec4& c = IMPLOT_AUTO_COL) const {
+        ImVec4 ic = resolveColor(c);
+        ImPlot::SetNextLineStyle(ic, lineWeight);
+        ImPlot::SetNextMarkerStyle(format.marker, markerSize, ic, markerWeight, ic);
+    }
+};
+
+/**
+ * Explicit flags take precedence over those of the style.
+ */
+
+static ImPlotLineFlags resolveLineFlags(const PlotStyle* style,
+                                        const std::optional<ImPlotLineFlags>& flags) {
+
+    if (flags.has_value()) {
+        return *flags;
+    }
+
+    return style != nullptr ? style->flags : ImPlotLineFlags_None;
+}
+
+/**
+ * Plots lines and/or markers, the style must be set beforehand.
+ * Per-point colors are only used if their type is not None.
+ */
+
+static void plotFormatted(const char* label,
+                          PlotArrayInfo& pai,
+                          const PlotFormat& pf,
+                          const PlotColorInfo& colors,
+                          bool lod,
+                          ImPlotLineFlags flags) {
+
+    if (colors.type != PlotColorType::None) {
+        ImPlot::customPlot(label, pai, colors, !pf.line, flags, lod);
+    } else {
+        // plot lines and markers
+        // (decimation would drop markers, so lod is only used for pure lines)
+
+        if (pf.line) {
+            bool lineOnly = pf.marker == ImPlotMarker_None;
+            ImPlot::plotLine(label, pai, flags, lod && lineOnly);
+        } else {
+            ImPlot::plotScatter(label, pai, flags);
+        }
+    }
+}
+
+/**
+ * Counts the plot_many calls in the current plot, so that the rows of
+ * different calls get distinct default labels.
+ */
+
+static int nextPlotManyIndex() {
+
+    static ImGuiID plotId = 0;
+    static int frame = -1;
+    static int count = 0;
+
+    ImPlotPlot* plot = ImPlot::GetCurrentPlot();
+    ImGuiID id = plot != nullptr ? plot->ID : 0;
+
+    if (id != plotId || frame != ImGui::GetFrameCount()) {
+        plotId = id;
+        frame = ImGui::GetFrameCount();
+        count = 0;
+    }
+
+    return count++;
+}
+
+/**
+ * Sets the style of a batch of shapes and plots their outlines.
+ * Colors may either be a single color or one color per shape.
+ */
+
+static void plotShapes(const char* label,
+                       const std::vector<double>& xs,
+                       const std::vector<double>& ys,
+                       int shapeCount,
+                       int vertexCount,
+                       py::handle color,
+                       py::handle fillColor,
+                       bool fill,
+                       float fillAlpha,
+                       float lineWeight,
+                       const PlotStyle* style,
+                       const std::optional<ImPlotLineFlags>& lineFlags) {
+
+    ImPlotLineFlags flags = resolveLineFlags(style, lineFlags);
+
+    py::array noValues;
+
+    PlotColorInfo lineColors = interpretPointColors(color, noValues);
+    PlotColorInfo fillColors = interpretPointColors(fillColor, noValues);
+
+    ImVec4 lineCol = IMPLOT_AUTO_COL;
+    ImVec4 fillCol = IMPLOT_AUTO_COL;
+
+    if (lineColors.type == PlotColorType::None) {
+        lineCol = interpretColor(color);
+    }
+
+    if (style != nullptr) {
+        lineCol = style->resolveColor(lineCol);
+        lineWeight = style->lineWeight;
+    }
+
+    if (fillColors.type == PlotColorType::None && !fillColor.is_none()) {
+        fillCol = interpretColor(fillColor);
+    }
+
+    if (fillCol.w == -1) {
+        fillCol = IMPLOT_AUTO_COL;
+    }
+
+    ImPlot::SetNextLineStyle(lineCol, lineWeight);
+    ImPlot::SetNextFillStyle(fillCol, fillAlpha);
+
+    ImPlot::plotPolygons(label,
+                         xs.data(),
+                         ys.data(),
+                         shapeCount,
+                         vertexCount,
+                         lineColors,
+                         fillColors,
+                         fill,
+                         flags);
+}
+
+/**
+ * Returns element i of a per-shape parameter, which may also be given
+ * once for all shapes.
+ */
+
+static double shapeParam(const array_like<double>& values, size_t i, double fallback) {
+
+    if (values.size() == 0) {
+        return fallback;
+    }
+    if (values.size() == 1) {
+        return values.data()[0];
+    }
+
+    return values.data()[i];
+}
+
 void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
 
     /**
@@ -396,6 +634,11 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     m.def("set_axis", &ImPlot::SetAxis);
     m.def("set_axes", &ImPlot::SetAxes);
 
+    m.def("set_plot_render_threads", &ImPlot::setRenderThreads,
+            py::arg("threads"));
+
+    m.def("get_plot_kernel_isa", &getKernelIsa);
+
     m.def("push_plot_style_color", [](ImPlotCol idx, py::handle& col){
         ImVec4 color = interpretColor(col);
         ImPlot::PushStyleColor(idx, color);
@@ -408,88 +651,120 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     },
     py::arg("count") = 1);
 
-    m.def("plot", [&](array_like<double> x,
-                      array_like<double> y,
+    py::class_<PlotStyle>(m, "PlotStyle")
+        .def(py::init([](std::string fmt,
+                         py::handle color,
+                         float lineWeight,
+                         float markerSize,
+                         float markerWeight,
+                         float shadeAlpha,
+                         int flags) {
+            PlotStyle style;
+            style.setFmt(fmt);
+            style.setColor(color);
+            style.lineWeight = lineWeight;
+            style.markerSize = markerSize;
+            style.markerWeight = markerWeight;
+            style.shadeAlpha = shadeAlpha;
+            style.flags = flags;
+            return style;
+        }),
+        py::arg("fmt") = "-",
+        py::arg("color") = py::array(),
+        py::arg("line_weight") = 1.0f, 
+        py::arg("marker_size") = 4.0f, 
+        py::arg("marker_weight") = 1.0f,
+        py::arg("shade_alpha") = 0.3f,
+        py::arg("flags") = 0)
+        .def_property("fmt",
+            [](PlotStyle& s) { return s.fmt; },
+            &PlotStyle::setFmt)
+        .def_property("color",
+            [](PlotStyle& s) { return s.colorHandle; },
+            [](PlotStyle& s, py::object c) { s.setColor(c); })
+        .def_readwrite("line_weight", &PlotStyle::lineWeight)
+        .def_readwrite("marker_size", &PlotStyle::markerSize)
+        .def_readwrite("marker_weight", &PlotStyle::markerWeight)
+        .def_readwrite("shade_alpha", &PlotStyle::shadeAlpha)
+        .def_readwrite("flags", &PlotStyle::flags);
+
+    m.def("plot", [&](py::handle xObj,
+                      py::handle yObj,
                       std::string fmt,
                       std::string label,
                       py::handle color,
-                      array_like<double> shade,
+                      py::handle shadeObj,
                       float shadeAlpha,
                       float lineWeight,
                       float markerSize,
                       float markerWeight,
-                      ImPlotLineFlags flags) {
+                      double xScale,
+                      double xStart,
+                      bool lod,
+                      bool monotonic,
+                      py::handle lowerObj,
+                      py::handle upperObj,
+                      py::handle colorValuesObj,
+                      ImPlotColormap colormap,
+                      ImPlotRange colorRange,
+                      const PlotStyle* style,
+                      std::optional<ImPlotLineFlags> lineFlags) {
+
+        ImPlotLineFlags flags = resolveLineFlags(style, lineFlags);
 
         // interpret data
 
-        PlotArrayInfo pai = interpretPlotArrays(x, y);
+        py::array x = asArray(xObj);
+        py::array y = asArray(yObj);
 
-        // interpret marker format
+        PlotArrayInfo pai = interpretPlotArrays(x, y, xScale, xStart);
+        pai.monotonicX |= monotonic;
 
-        static std::regex re{"(-)?(o|s|d|\\*|\\+)?"};
+        PlotFormat pf;
 
-        std::smatch match;
-        std::regex_search(fmt, match, re);
+        // explicit colors are used with and without a style
 
-        std::vector<std::string> groups;
-        for (auto m : match) {
-            if (m.matched) {
-                groups.push_back(m.str());
-            } else {
-                groups.push_back("");
-            }
-        }
+        py::array colorValues = asArray(colorValuesObj);
 
-        ImPlotMarker markerStyle = ImPlotMarker_None;
-        if (groups[2] == "o") {
-            markerStyle = ImPlotMarker_Circle;
-        } else if (groups[2] == "s") {
-            markerStyle = ImPlotMarker_Square;
-        } else if (groups[2] == "d") {
-            markerStyle = ImPlotMarker_Diamond;
-        } else if (groups[2] == "+") {
-            markerStyle = ImPlotMarker_Cross;
-        } else if (groups[2] == "*") {
-            markerStyle = ImPlotMarker_Asterisk;
+        PlotColorInfo pci = interpretPointColors(color, colorValues, colormap, colorRange);
+
+        ImVec4 ic(1.0f, 1.0f, 1.0f, 1.0f);
+        if (pci.type == PlotColorType::None) {
+            ic = interpretColor(color);
         }
 
-        bool isArray = false;
-        ImVec4 ic = interpretColor(color, &isArray);
+        if (style != nullptr) {
+            // everything else has been parsed already
+            pf = style->format;
+            shadeAlpha = style->shadeAlpha;
+            style->apply(ic);
+        } else {
+            // interpret marker format
 
-        // set style vars
+            pf = parsePlotFormat(fmt);
 
-        ImPlot::SetNextLineStyle(ic, lineWeight);
-        ImPlot::SetNextMarkerStyle(markerStyle, markerSize, ic, markerWeight, ic);
+            // set style vars
 
-        if (isArray) {
-            ImPlot::customPlot(label.c_str(), pai, color, groups[1] != "-", flags);
-        } else {
-            // plot lines and markers
+            ImPlot::SetNextLineStyle(ic, lineWeight);
+            ImPlot::SetNextMarkerStyle(pf.marker, markerSize, ic, markerWeight, ic);
+        }
 
-            if (groups[1] == "-") {
-                ImPlot::PlotLine(label.c_str(), pai.xDataPtr, pai.yDataPtr, pai.count, flags);
-            } else {
-                ImPlot::PlotScatter(label.c_str(), pai.xDataPtr, pai.yDataPtr, pai.count, flags);
-            }
+        plotFormatted(label.c_str(), pai, pf, pci, lod, flags);
 
+        if (pci.type == PlotColorType::None) {
             // plot shade if needed
+            // (the band is computed on the fly from y and the offsets)
 
-            size_t shadeCount = std::min(pai.count, (size_t)shade.shape()[0]);
-
-            if (shadeCount != 0) {
-                if (1 == shade.ndim()) {
-                    ImPlot::PushStyleVar(ImPlotStyleVar_FillAlpha, shadeAlpha);
-                    auto mean = py::cast<py::array_t<double>>(y[py::slice(0, shadeCount, 1)]);
-                    py::array_t<double> upper = mean + shade;
-                    py::array_t<double> lower = mean - shade;
-                    ImPlot::PlotShaded(label.c_str(),
-                                       pai.xDataPtr,
-                                       lower.data(),
-                                       upper.data(),
-                                       shadeCount,
-                                       flags);
-                    ImPlot::PopStyleVar();
-                }
+            py::array shade = asArray(shadeObj);
+            py::array lower = asArray(lowerObj);
+            py::array upper = asArray(upperObj);
+
+            PlotBandInfo band = interpretPlotBand(shade, lower, upper);
+
+            if (band.count != 0) {
+                ImPlot::PushStyleVar(ImPlotStyleVar_FillAlpha, shadeAlpha);
+                ImPlot::plotShaded(label.c_str(), pai, band, flags);
+                ImPlot::PopStyleVar();
             }
         }
     },
@@ -503,24 +778,278 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     py::arg("line_weight") = 1.0f, 
     py::arg("marker_size") = 4.0f, 
     py::arg("marker_weight") = 1.0f,
+    py::arg("xscale") = 1.0,
+    py::arg("xstart") = 0.0,
+    py::arg("lod") = false,
+    py::arg("monotonic") = false,
+    py::arg("lower") = py::array(),
+    py::arg("upper") = py::array(),
+    py::arg("color_values") = py::array(),
+    py::arg("colormap") = IMPLOT_AUTO,
+    py::arg("color_range") = ImPlotRange(0.0, 0.0),
+    py::arg("style") = nullptr,
+    py::arg("flags") = py::none());
+
+    m.def("plot_many", [&](py::handle xObj,
+                           py::handle ysObj,
+                           std::vector<std::string> labels,
+                           py::handle colors,
+                           std::string fmt,
+                           float lineWeight,
+                           float markerSize,
+                           float markerWeight,
+                           double xScale,
+                           double xStart,
+                           bool lod,
+                           bool monotonic,
+                           ImPlotLineFlags flags) {
+
+        py::array x = asArray(xObj);
+        py::array ys = asArray(ysObj);
+
+        // a single 2d array contains the rows only
+        if (0 == ys.size() && 2 == x.ndim()) {
+            std::swap(x, ys);
+        }
+
+        ptrdiff_t rowStride = 0;
+        PlotArrayInfo pai = interpretPlotRows(x, ys, rowStride, xScale, xStart);
+        pai.monotonicX |= monotonic;
+
+        size_t rows = pai.yArray.shape(0);
+
+        if (!labels.empty() && labels.size() != rows) {
+            throw py::value_error("Number of labels ("
+                    + std::to_string(labels.size())
+                    + ") != number of rows ("
+                    + std::to_string(rows)
+                    + ")");
+        }
+
+        // colors are either sampled from the colormap,
+        // given per row or shared by all rows
+
+        std::vector<ImVec4> rowColors;
+        ImVec4 sharedColor = IMPLOT_AUTO_COL;
+        bool useColormap = colors.is_none();
+
+        // a sequence is only one color per row, if its elements are colors
+        // themselves, e.g. ["r", "g"] or [(1, 0, 0), (0, 1, 0)], but not [1, 0, 0]
+
+        bool colorSequence = false;
+
+        if (py::isinstance<py::list>(colors) || py::isinstance<py::tuple>(colors)) {
+            for (py::handle c : colors) {
+                colorSequence = py::isinstance<py::str>(c)
+                    || py::isinstance<py::list>(c)
+                    || py::isinstance<py::tuple>(c)
+                    || py::isinstance<py::array>(c);
+                break;
+            }
+        }
+
+        if (colorSequence) {
+            for (py::handle c : colors) {
+                rowColors.push_back(interpretColor(c));
+            }
+        } else if (!useColormap) {
+            bool perRow = false;
+            sharedColor = interpretColor(colors, &perRow);
+            if (perRow) {
+                array_like<float> colorArray = array_like<float>::ensure(colors);
+                for (size_t i = 0; i < (size_t)colorArray.shape(0); ++i) {
+                    rowColors.push_back(ImVec4(colorArray.at(i, 0),
+                                               colorArray.at(i, 1),
+                                               colorArray.at(i, 2),
+                                               colorArray.at(i, 3)));
+                }
+            }
+        }
+
+        if (!rowColors.empty() && rowColors.size() != rows) {
+            throw py::value_error("Number of colors ("
+                    + std::to_string(rowColors.size())
+                    + ") != number of rows ("
+                    + std::to_string(rows)
+                    + ")");
+        }
+
+        PlotFormat pf = parsePlotFormat(fmt);
+
+        const unsigned char* firstRow = (const unsigned char*)pai.yDataPtr;
+
+        std::string labelPrefix = "##many" + std::to_string(nextPlotManyIndex()) + "_";
+
+        for (size_t i = 0; i < rows; ++i) {
+
+            ImVec4 ic = sharedColor;
+
+            if (!rowColors.empty()) {
+                ic = rowColors[i];
+            } else if (useColormap) {
+                float t = rows > 1 ? (float)i / (float)(rows - 1) : 0.0f;
+                ic = ImPlot::SampleColormap(t);
+            }
+
+            ImPlot::SetNextLineStyle(ic, lineWeight);
+            ImPlot::SetNextMarkerStyle(pf.marker, markerSize, ic, markerWeight, ic);
+
+            pai.yDataPtr = firstRow + (ptrdiff_t)i * rowStride;
+
+            std::string label = labels.empty()
+                ? labelPrefix + std::to_string(i)
+                : labels[i];
+
+            plotFormatted(label.c_str(), pai, pf, PlotColorInfo(), lod, flags);
+        }
+    },
+    py::arg("x"),
+    py::arg("ys") = py::array(),
+    py::arg("labels") = std::vector<std::string>(),
+    py::arg("colors") = py::none(),
+    py::arg("fmt") = "-",
+    py::arg("line_weight") = 1.0f, 
+    py::arg("marker_size") = 4.0f, 
+    py::arg("marker_weight") = 1.0f,
+    py::arg("xscale") = 1.0,
+    py::arg("xstart") = 0.0,
+    py::arg("lod") = false,
+    py::arg("monotonic") = false,
     py::arg("flags") = ImPlotLineFlags_None);
 
-    m.def("plot_bars", [&](array_like<double> x,
-                           array_like<double> y,
+    py::class_<PlotSeries>(m, "PlotSeries")
+        .def(py::init([](py::handle x, py::handle y, double xScale, double xStart) {
+            PlotSeries series;
+            py::array xa = asArray(x);
+            py::array ya = asArray(y);
+            series.setData(xa, ya, xScale, xStart);
+            return series;
+        }),
+        py::arg("x"),
+        py::arg("y") = py::array(),
+        py::arg("xscale") = 1.0,
+        py::arg("xstart") = 0.0)
+        .def("set_data", [](PlotSeries& series,
+                            py::handle x,
+                            py::handle y,
+                            double xScale,
+                            double xStart) {
+            py::array xa = asArray(x);
+            py::array ya = asArray(y);
+            series.setData(xa, ya, xScale, xStart);
+        },
+        py::arg("x"),
+        py::arg("y") = py::array(),
+        py::arg("xscale") = 1.0,
+        py::arg("xstart") = 0.0)
+        .def("__len__", [](PlotSeries& series) {
+            return series.count;
+        });
+
+    m.def("plot_series", [&](PlotSeries& series,
+                             std::string label,
+                             py::handle color,
+                             float lineWeight,
+                             ImPlotItemFlags flags) {
+
+        ImPlot::SetNextLineStyle(interpretColor(color), lineWeight);
+        series.plot(label.c_str(), flags);
+    },
+    py::arg("series"),
+    py::arg("label") = "",
+    py::arg("color") = py::array(),
+    py::arg("line_weight") = 1.0f, 
+    py::arg("flags") = ImPlotItemFlags_None);
+
+    py::class_<RingBuffer>(m, "RingBuffer")
+        .def(py::init<size_t, size_t, py::dtype>(),
+        py::arg("capacity"),
+        py::arg("channels") = 1,
+        py::arg("dtype") = py::dtype::of<double>())
+        .def("append", [](RingBuffer& buffer, py::handle samples) {
+            py::array sa = asArray(samples);
+            buffer.append(sa);
+        },
+        py::arg("samples"))
+        .def("clear", &RingBuffer::clear)
+        .def("to_array", &RingBuffer::toArray)
+        .def("__len__", [](RingBuffer& buffer) {
+            return buffer.size;
+        })
+        .def_readonly("capacity", &RingBuffer::capacity)
+        .def_readonly("channels", &RingBuffer::channels)
+        .def_readonly("total", &RingBuffer::total);
+
+    m.def("plot_ring", [&](RingBuffer& buffer,
+                           int channel,
+                           int xChannel,
+                           std::string fmt,
+                           std::string label,
+                           py::handle color,
+                           float lineWeight,
+                           float markerSize,
+                           float markerWeight,
+                           double xScale,
+                           double xStart,
+                           bool lod,
+                           ImPlotLineFlags flags) {
+
+        PlotArrayInfo pai = buffer.plotArrays(channel, xChannel, xScale, xStart);
+
+        PlotFormat pf = parsePlotFormat(fmt);
+
+        py::array noValues;
+        PlotColorInfo pci = interpretPointColors(color, noValues);
+
+        ImVec4 ic(1.0f, 1.0f, 1.0f, 1.0f);
+        if (pci.type == PlotColorType::None) {
+            ic = interpretColor(color);
+        }
+
+        ImPlot::SetNextLineStyle(ic, lineWeight);
+        ImPlot::SetNextMarkerStyle(pf.marker, markerSize, ic, markerWeight, ic);
+
+        plotFormatted(label.c_str(), pai, pf, pci, lod, flags);
+    },
+    py::arg("buffer"),
+    py::arg("channel") = 0,
+    py::arg("x_channel") = -1,
+    py::arg("fmt") = "-",
+    py::arg("label") = "",
+    py::arg("color") = py::array(),
+    py::arg("line_weight") = 1.0f, 
+    py::arg("marker_size") = 4.0f, 
+    py::arg("marker_weight") = 1.0f,
+    py::arg("xscale") = 1.0,
+    py::arg("xstart") = 0.0,
+    py::arg("lod") = false,
+    py::arg("flags") = ImPlotLineFlags_None);
+
+    m.def("plot_bars", [&](py::handle xObj,
+                           py::handle yObj,
                            std::string label,
                            py::handle& color,
                            double bar_size,
+                           double xScale,
+                           double xStart,
+                           const PlotStyle* style,
                            ImPlotBarsFlags flags) {
 
-        PlotArrayInfo pai = interpretPlotArrays(x, y);
+        py::array x = asArray(xObj);
+        py::array y = asArray(yObj);
+
+        PlotArrayInfo pai = interpretPlotArrays(x, y, xScale, xStart);
 
         ImVec4 col = interpretColor(color);
+
+        if (style != nullptr) {
+            col = style->resolveColor(col);
+        }
+
         ImPlot::SetNextFillStyle(col);
 
-        ImPlot::PlotBars(label.c_str(),
-                         pai.xDataPtr,
-                         pai.yDataPtr,
-                         pai.count,
+        ImPlot::plotBars(label.c_str(),
+                         pai,
                          bar_size,
                          flags);
     },
@@ -529,6 +1058,9 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     py::arg("label") = "",
     py::arg("color") = ImVec4(0.0f, 0.0f, 0.0f, -1.0f),
     py::arg("bar_size") = 0.5,
+    py::arg("xscale") = 1.0,
+    py::arg("xstart") = 0.0,
+    py::arg("style") = nullptr,
     py::arg("flags") = ImPlotBarsFlags_None);
 
     m.def("plot_image", [&](
@@ -543,9 +1075,14 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
                 py::handle& tint,
                 bool interpolate,
                 bool skip_upload,
-                ImPlotImageFlags flags) {
+                ImPlotImageFlags flags,
+                py::handle dirtyRect,
+                bool stream) {
 
         ImageInfo info = interpretImage(image);
+
+        ImageRect dirty;
+        bool hasDirty = interpretImageRect(dirtyRect, dirty);
         
         if (displayWidth < 0) {
             displayWidth = info.imageWidth;
@@ -554,11 +1091,20 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
             displayHeight = info.imageHeight;
         }
 
-        GLuint textureId = uploadImage(label, info, image, skip_upload, interpolate);
-
         ImPlotPoint boundsMin(x, y);
         ImPlotPoint boundsMax(x + displayWidth, y + displayHeight);
 
+        ImVec2 pixelSize = ImPlot::PlotToPixels(boundsMax) - ImPlot::PlotToPixels(boundsMin);
+
+        GLuint textureId = uploadImage(label,
+                                       info,
+                                       image,
+                                       skip_upload,
+                                       interpolate,
+                                       hasDirty ? &dirty : nullptr,
+                                       stream,
+                                       textureDisplaySize(pixelSize, uv0, uv1));
+
         ImVec4 tintCol = interpretColor(tint);
 
         ImPlot::PlotImage(
@@ -582,7 +1128,115 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     py::arg("tint") = ImVec4(1.0f, 1.0f, 1.0f, 1.0f),
     py::arg("interpolate") = true,
     py::arg("skip_upload") = false,
-    py::arg("flags") = ImPlotImageFlags_None);
+    py::arg("flags") = ImPlotImageFlags_None,
+    py::arg("dirty_rect") = py::none(),
+    py::arg("stream") = false);
+
+    m.def("plot_heatmap", [&](
+                std::string label,
+                py::array& values,
+                std::array<double, 4> bounds,
+                ImPlotColormap colormap,
+                double scaleMin,
+                double scaleMax,
+                bool interpolate,
+                bool skip_upload,
+                ImPlotItemFlags flags) {
+
+        plotHeatmap(label.c_str(),
+                    values,
+                    ImPlotPoint(bounds[0], bounds[1]),
+                    ImPlotPoint(bounds[2], bounds[3]),
+                    colormap,
+                    scaleMin,
+                    scaleMax,
+                    interpolate,
+                    skip_upload,
+                    flags);
+    },
+    py::arg("label"),
+    py::arg("values"),
+    py::arg("bounds") = std::array<double, 4>{0.0, 0.0, 1.0, 1.0},
+    py::arg("colormap") = IMPLOT_AUTO,
+    py::arg("scale_min") = 0.0,
+    py::arg("scale_max") = 0.0,
+    py::arg("interpolate") = false,
+    py::arg("skip_upload") = false,
+    py::arg("flags") = ImPlotItemFlags_None);
+
+    m.def("plot_histogram", [&](
+                py::handle valuesObj,
+                std::string label,
+                int bins,
+                ImPlotRange range,
+                bool density,
+                bool cumulative,
+                bool horizontal,
+                double barScale,
+                bool cache) {
+
+        py::array values = asArray(valuesObj);
+
+        plotHistogram(label.c_str(),
+                      values,
+                      bins,
+                      range,
+                      density,
+                      cumulative,
+                      horizontal,
+                      barScale,
+                      cache);
+    },
+    py::arg("values"),
+    py::arg("label") = "",
+    py::arg("bins") = (int)ImPlotBin_Sturges,
+    py::arg("range") = ImPlotRange(0.0, 0.0),
+    py::arg("density") = false,
+    py::arg("cumulative") = false,
+    py::arg("horizontal") = false,
+    py::arg("bar_scale") = 1.0,
+    py::arg("cache") = true);
+
+    m.def("plot_histogram_2d", [&](
+                py::handle xObj,
+                py::handle yObj,
+                std::string label,
+                int xBins,
+                int yBins,
+                ImPlotRange xRange,
+                ImPlotRange yRange,
+                bool density,
+                ImPlotColormap colormap,
+                bool cache,
+                ImPlotItemFlags flags) {
+
+        py::array x = asArray(xObj);
+        py::array y = asArray(yObj);
+
+        ImPlotRect range(xRange.Min, xRange.Max, yRange.Min, yRange.Max);
+
+        plotHistogram2d(label.c_str(),
+                        x,
+                        y,
+                        xBins,
+                        yBins,
+                        range,
+                        density,
+                        colormap,
+                        cache,
+                        flags);
+    },
+    py::arg("x"),
+    py::arg("y") = py::array(),
+    py::arg("label") = "",
+    py::arg("x_bins") = (int)ImPlotBin_Sturges,
+    py::arg("y_bins") = (int)ImPlotBin_Sturges,
+    py::arg("x_range") = ImPlotRange(0.0, 0.0),
+    py::arg("y_range") = ImPlotRange(0.0, 0.0),
+    py::arg("density") = false,
+    py::arg("colormap") = IMPLOT_AUTO,
+    py::arg("cache") = true,
+    py::arg("flags") = ImPlotItemFlags_None);
 
     m.def("plot_image_texture", [&](
                 std::string label,
@@ -646,11 +1300,13 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     py::arg("flags") = ImPlotDragToolFlags_None);
 
     m.def("plot_vlines", [&](std::string label,
-                            array_like<double> xs,
+                            py::handle xsObj,
                             py::handle color,
                             float width,
                             ImPlotInfLinesFlags flags) {
 
+        py::array xs = asArray(xsObj);
+
         assert_shape(xs, {{-1}});
 
         flags &= ~ImPlotInfLinesFlags_Horizontal;
@@ -658,7 +1314,20 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
         ImVec4 c = interpretColor(color);
         ImPlot::SetNextLineStyle(c, width);
 
-        ImPlot::PlotInfLines(label.c_str(), xs.data(), xs.shape(0), flags);
+        dispatchDataType(interpretDataType(xs), [&](auto tag) {
+            using T = decltype(tag);
+            py::array values = array_view<T>::ensure(xs);
+            if (values.strides(0) < 0) {
+                // implot only handles positive strides
+                values = array_like<T>::ensure(values);
+            }
+            ImPlot::PlotInfLines(label.c_str(),
+                                 (const T*)values.data(),
+                                 values.shape(0),
+                                 flags,
+                                 0,
+                                 (int)values.strides(0));
+        });
     },
     py::arg("label"),
     py::arg("xs"),
@@ -667,11 +1336,13 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     py::arg("flags") = ImPlotInfLinesFlags_None);
 
     m.def("plot_hlines", [&](std::string label,
-                            array_like<double> ys,
+                            py::handle ysObj,
                             py::handle color,
                             float width,
                             ImPlotInfLinesFlags flags) {
 
+        py::array ys = asArray(ysObj);
+
         assert_shape(ys, {{-1}});
 
         flags |= ImPlotInfLinesFlags_Horizontal;
@@ -679,7 +1350,20 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
         ImVec4 c = interpretColor(color);
         ImPlot::SetNextLineStyle(c, width);
 
-        ImPlot::PlotInfLines(label.c_str(), ys.data(), ys.shape(0), flags);
+        dispatchDataType(interpretDataType(ys), [&](auto tag) {
+            using T = decltype(tag);
+            py::array values = array_view<T>::ensure(ys);
+            if (values.strides(0) < 0) {
+                // implot only handles positive strides
+                values = array_like<T>::ensure(values);
+            }
+            ImPlot::PlotInfLines(label.c_str(),
+                                 (const T*)values.data(),
+                                 values.shape(0),
+                                 flags,
+                                 0,
+                                 (int)values.strides(0));
+        });
     },
     py::arg("label"),
     py::arg("ys"),
@@ -812,7 +1496,10 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
                            ImPlotPoint offset,
                            float rotation,
                            float lineWeight,
-                           ImPlotLineFlags flags) {
+                           const PlotStyle* style,
+                           std::optional<ImPlotLineFlags> lineFlags) {
+
+        ImPlotLineFlags flags = resolveLineFlags(style, lineFlags);
 
         std::vector<double> xs(5);
         std::vector<double> ys(5);
@@ -842,8 +1529,15 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
         xs[4] = xs[0];
         ys[4] = ys[0];
 
+        ImVec4 lineColor = interpretColor(color);
+
+        if (style != nullptr) {
+            lineColor = style->resolveColor(lineColor);
+            lineWeight = style->lineWeight;
+        }
+
         ImPlot::PushStyleVar(ImPlotStyleVar_LineWeight, lineWeight);
-        ImPlot::PushStyleColor(ImPlotCol_Line, interpretColor(color));
+        ImPlot::PushStyleColor(ImPlotCol_Line, lineColor);
         ImPlot::PlotLine(label.c_str(), xs.data(), ys.data(), 5, flags);
         ImPlot::PopStyleColor();
         ImPlot::PopStyleVar();
@@ -855,7 +1549,8 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     py::arg("offset") = ImPlotPoint(0.5f, 0.5f),
     py::arg("rotation") = 0.0f,
     py::arg("line_weight") = 1.0f,
-    py::arg("flags") = ImPlotLineFlags_None);
+    py::arg("style") = nullptr,
+    py::arg("flags") = py::none());
 
     m.def("plot_circle", [&](ImPlotPoint center,
                              double radius,
@@ -863,7 +1558,10 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
                              py::handle color,
                              size_t segments,
                              float lineWeight,
-                             ImPlotLineFlags flags) {
+                             const PlotStyle* style,
+                             std::optional<ImPlotLineFlags> lineFlags) {
+
+        ImPlotLineFlags flags = resolveLineFlags(style, lineFlags);
 
         size_t steps = segments + 1;
 
@@ -878,8 +1576,15 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
             ys[i] = center.y + radius * std::sin(angle);
         }
 
+        ImVec4 lineColor = interpretColor(color);
+
+        if (style != nullptr) {
+            lineColor = style->resolveColor(lineColor);
+            lineWeight = style->lineWeight;
+        }
+
         ImPlot::PushStyleVar(ImPlotStyleVar_LineWeight, lineWeight);
-        ImPlot::PushStyleColor(ImPlotCol_Line, interpretColor(color));
+        ImPlot::PushStyleColor(ImPlotCol_Line, lineColor);
         ImPlot::PlotLine(label.c_str(), xs.data(), ys.data(), steps, flags);
         ImPlot::PopStyleColor();
         ImPlot::PopStyleVar();
@@ -890,7 +1595,158 @@ void loadImplotPythonBindings(pybind11::module& m, ImViz& viz) {
     py::arg("color") = py::array(),
     py::arg("segments") = 36,
     py::arg("line_weight") = 1.0f,
-    py::arg("flags") = ImPlotLineFlags_None);
+    py::arg("style") = nullptr,
+    py::arg("flags") = py::none());
+
+    m.def("plot_circles", [&](array_like<double> centers,
+                              array_like<double> radii,
+                              std::string label,
+                              py::handle color,
+                              py::handle fillColor,
+                              bool fill,
+                              float fillAlpha,
+                              size_t segments,
+                              float lineWeight,
+                              const PlotStyle* style,
+                              std::optional<ImPlotLineFlags> lineFlags) {
+
+        assert_shape(centers, {{-1, 2}});
+
+        size_t count = centers.shape(0);
+
+        if (radii.size() != 1 && (size_t)radii.size() != count) {
+            throw py::value_error("Expected one radius or one radius per circle");
+        }
+        if (segments < 3) {
+            throw py::value_error("Circles need at least 3 segments");
+        }
+
+        std::vector<double> cs(segments);
+        std::vector<double> sn(segments);
+
+        double step = M_PI * 2 / segments;
+
+        for (size_t k = 0; k < segments; ++k) {
+            cs[k] = std::cos(step * k);
+            sn[k] = std::sin(step * k);
+        }
+
+        std::vector<double> xs(count * segments);
+        std::vector<double> ys(count * segments);
+
+        for (size_t i = 0; i < count; ++i) {
+            double cx = centers.at(i, 0);
+            double cy = centers.at(i, 1);
+            double r = shapeParam(radii, i, 1.0);
+            for (size_t k = 0; k < segments; ++k) {
+                xs[i * segments + k] = cx + r * cs[k];
+                ys[i * segments + k] = cy + r * sn[k];
+            }
+        }
+
+        plotShapes(label.c_str(),
+                   xs,
+                   ys,
+                   count,
+                   segments,
+                   color,
+                   fillColor,
+                   fill,
+                   fillAlpha,
+                   lineWeight,
+                   style,
+                   lineFlags);
+    },
+    py::arg("centers"),
+    py::arg("radii"),
+    py::arg("label") = "",
+    py::arg("color") = py::array(),
+    py::arg("fill_color") = py::none(),
+    py::arg("fill") = false,
+    py::arg("fill_alpha") = 0.5f,
+    py::arg("segments") = 36,
+    py::arg("line_weight") = 1.0f,
+    py::arg("style") = nullptr,
+    py::arg("flags") = py::none());
+
+    m.def("plot_rects", [&](array_like<double> positions,
+                            array_like<double> sizes,
+                            array_like<double> rotations,
+                            std::string label,
+                            py::handle color,
+                            py::handle fillColor,
+                            bool fill,
+                            float fillAlpha,
+                            ImPlotPoint offset,
+                            float lineWeight,
+                            const PlotStyle* style,
+                            std::optional<ImPlotLineFlags> lineFlags) {
+
+        assert_shape(positions, {{-1, 2}});
+
+        size_t count = positions.shape(0);
+
+        bool sharedSize = sizes.ndim() == 1;
+
+        if (sharedSize) {
+            assert_shape(sizes, {{2}});
+        } else {
+            assert_shape(sizes, {{(int)count, 2}});
+        }
+
+        if (rotations.size() > 1 && (size_t)rotations.size() != count) {
+            throw py::value_error("Expected one rotation or one rotation per rect");
+        }
+
+        std::vector<double> xs(count * 4);
+        std::vector<double> ys(count * 4);
+
+        for (size_t i = 0; i < count; ++i) {
+
+            double w = sharedSize ? sizes.at(0) : sizes.at(i, 0);
+            double h = sharedSize ? sizes.at(1) : sizes.at(i, 1);
+
+            double px = -w * offset.x;
+            double py = -h * offset.y;
+
+            double cornersX[4] = {px, px + w, px + w, px};
+            double cornersY[4] = {py, py, py + h, py + h};
+
+            double rotation = shapeParam(rotations, i, 0.0);
+            double s = std::sin(rotation);
+            double c = std::cos(rotation);
+
+            for (int k = 0; k < 4; ++k) {
+                xs[i * 4 + k] = c * cornersX[k] - s * cornersY[k] + positions.at(i, 0);
+                ys[i * 4 + k] = s * cornersX[k] + c * cornersY[k] + positions.at(i, 1);
+            }
+        }
+
+        plotShapes(label.c_str(),
+                   xs,
+                   ys,
+                   count,
+                   4,
+                   color,
+                   fillColor,
+                   fill,
+                   fillAlpha,
+                   lineWeight,
+                   style,
+                   lineFlags);
+    },
+    py::arg("positions"),
+    py::arg("sizes"),
+    py::arg("rotations") = py::array(),
+    py::arg("label") = "",
+    py::arg("color") = py::array(),
+    py::arg("fill_color") = py::none(),
+    py::arg("fill") = false,
+    py::arg("fill_alpha") = 0.5f,
+    py::arg("offset") = ImPlotPoint(0.5f, 0.5f),
+    py::arg("line_weight") = 1.0f,
+    py::arg("style") = nullptr,
+    py::arg("flags") = py::none());
 
     m.def("is_plot_selected", ImPlot::IsPlotSelected);
     m.def("is_plot_hovered", ImPlot::IsPlotHovered);
@@ -4,3 +4,6 @@ void checkAssertion(bool expr, const char* exprStr);
 
 #define IM_ASSERT(_EXPR) checkAssertion(_EXPR, #_EXPR)
 #define IMGUI_DEFINE_MATH_OPERATORS
+
+// large plots and point clouds easily exceed 64k vertices per draw list
+#define ImDrawIdx unsigned int
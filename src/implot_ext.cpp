@@ -30,17 +30,22 @@ SOFTWARE.
 // this is stupid ... i like it so much
 #include "implot_items.cpp"
 
+#include <cfloat>
 #include <sstream>
 #include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "plot_kernels.hpp"
+#include "thread_pool.hpp"
 
 namespace ImPlot {
 
-IMPLOT_INLINE void PrimLineCol2(ImDrawList& draw_list, const ImVec2& P1, const ImVec2& P2, float half_weight, ImU32 col0, ImU32 col1, const ImVec2& tex_uv0, const ImVec2 tex_uv1) {
-    float dx = P2.x - P1.x;
-    float dy = P2.y - P1.y;
-    IMPLOT_NORMALIZE2F_OVER_ZERO(dx, dy);
-    dx *= half_weight;
-    dy *= half_weight;
+IMPLOT_INLINE void PrimLineCol2Offset(ImDrawList& draw_list, const ImVec2& P1, const ImVec2& P2, const ImVec2& offset, ImU32 col0, ImU32 col1, const ImVec2& tex_uv0, const ImVec2 tex_uv1) {
+    const float dy = offset.x;
+    const float dx = -offset.y;
     draw_list._VtxWritePtr[0].pos.x = P1.x + dy;
     draw_list._VtxWritePtr[0].pos.y = P1.y - dx;
     draw_list._VtxWritePtr[0].uv    = tex_uv0;
@@ -68,46 +73,130 @@ IMPLOT_INLINE void PrimLineCol2(ImDrawList& draw_list, const ImVec2& P1, const I
     draw_list._VtxCurrentIdx += 4;
 }
 
+IMPLOT_INLINE void PrimLineCol2(ImDrawList& draw_list, const ImVec2& P1, const ImVec2& P2, float half_weight, ImU32 col0, ImU32 col1, const ImVec2& tex_uv0, const ImVec2 tex_uv1) {
+    float dx = P2.x - P1.x;
+    float dy = P2.y - P1.y;
+    IMPLOT_NORMALIZE2F_OVER_ZERO(dx, dy);
+    dx *= half_weight;
+    dy *= half_weight;
+    PrimLineCol2Offset(draw_list, P1, P2, ImVec2(dy, -dx), col0, col1, tex_uv0, tex_uv1);
+}
+
+/**
+ * Restricts a getter to a contiguous range of its points.
+ */
+template <typename _Getter>
+struct GetterSlice {
+    GetterSlice(const _Getter& getter, int start, int count) :
+        Getter(getter),
+        Start(start),
+        Count(count)
+    { }
+    template <typename I> IMPLOT_INLINE ImPlotPoint operator()(I idx) const {
+        return Getter(Start + idx);
+    }
+    const _Getter& Getter;
+    const int Start;
+    const int Count;
+};
+
+/**
+ * Points which have already been transformed to pixels, optionally with
+ * the quad offsets of the line segments between them.
+ */
+struct GetterPixels {
+    GetterPixels(const float* x, const float* y, const float* ox, const float* oy, int count) :
+        X(x),
+        Y(y),
+        OX(ox),
+        OY(oy),
+        Count(count)
+    { }
+    template <typename I> IMPLOT_INLINE ImPlotPoint operator()(I idx) const {
+        return ImPlotPoint(X[idx], Y[idx]);
+    }
+    const float* const X;
+    const float* const Y;
+    const float* const OX;
+    const float* const OY;
+    const int Count;
+};
+
+template <typename _Getter>
+struct IsPixelGetter : std::false_type { };
+
+template <>
+struct IsPixelGetter<GetterPixels> : std::true_type { };
+
+template <>
+struct IsPixelGetter<GetterSlice<GetterPixels>> : std::true_type { };
+
+template <typename _Getter>
+IMPLOT_INLINE ImVec2 pixelAt(const Transformer2& transformer, const _Getter& getter, int idx) {
+    return transformer(getter(idx));
+}
+
+IMPLOT_INLINE ImVec2 pixelAt(const Transformer2&, const GetterPixels& getter, int idx) {
+    return ImVec2(getter.X[idx], getter.Y[idx]);
+}
+
+IMPLOT_INLINE ImVec2 pixelAt(const Transformer2& transformer, const GetterSlice<GetterPixels>& getter, int idx) {
+    return pixelAt(transformer, getter.Getter, getter.Start + idx);
+}
+
+IMPLOT_INLINE ImVec2 offsetAt(const GetterPixels& getter, int idx) {
+    return ImVec2(getter.OX[idx], getter.OY[idx]);
+}
+
+IMPLOT_INLINE ImVec2 offsetAt(const GetterSlice<GetterPixels>& getter, int idx) {
+    return offsetAt(getter.Getter, getter.Start + idx);
+}
+
 template <class _Getter>
 struct CustomRendererLineStrip : RendererBase {
-    CustomRendererLineStrip(const _Getter& getter, ImU32 col, float weight) :
+    CustomRendererLineStrip(const _Getter& getter, const ImU32* colors, ImU32 col, float weight) :
         RendererBase(getter.Count - 1, 6, 4),
         Getter(getter),
+        Colors(colors),
         Col(col),
         HalfWeight(ImMax(1.0f,weight)*0.5f)
     {
-        P1 = this->Transformer(Getter(0));
+        P1 = pixelAt(this->Transformer, Getter, 0);
     }
     void Init(ImDrawList& draw_list) const {
         GetLineRenderProps(draw_list, HalfWeight, UV0, UV1);
     }
     IMPLOT_INLINE bool Render(ImDrawList& draw_list, const ImRect& cull_rect, int prim) const {
-        ImVec2 P2 = this->Transformer(Getter(prim + 1));
+        ImVec2 P2 = pixelAt(this->Transformer, Getter, prim + 1);
         if (!cull_rect.Overlaps(ImRect(ImMin(P1, P2), ImMax(P1, P2)))) {
             P1 = P2;
             return false;
         }
-        ImU32 col0 = ImGui::ColorConvertFloat4ToU32(colors[prim]);
-        ImU32 col1 = ImGui::ColorConvertFloat4ToU32(colors[prim+1]);
-        PrimLineCol2(draw_list,P1,P2,HalfWeight,col0,col1,UV0,UV1);
+        ImU32 col0 = Colors != nullptr ? Colors[prim] : Col;
+        ImU32 col1 = Colors != nullptr ? Colors[prim + 1] : Col;
+        if constexpr (IsPixelGetter<_Getter>::value) {
+            PrimLineCol2Offset(draw_list,P1,P2,offsetAt(Getter, prim),col0,col1,UV0,UV1);
+        } else {
+            PrimLineCol2(draw_list,P1,P2,HalfWeight,col0,col1,UV0,UV1);
+        }
         P1 = P2;
         return true;
     }
     const _Getter& Getter;
+    const ImU32* const Colors;
     const ImU32 Col;
     mutable float HalfWeight;
     mutable ImVec2 P1;
     mutable ImVec2 UV0;
     mutable ImVec2 UV1;
-
-    inline static ImVec4* colors;
 };
 
 template <class _Getter>
 struct CustomRendererMarkersFill : RendererBase {
-    CustomRendererMarkersFill(const _Getter& getter, const ImVec2* marker, int count, float size, ImU32 col) :
+    CustomRendererMarkersFill(const _Getter& getter, const ImU32* colors, const ImVec2* marker, int count, float size, ImU32 col) :
         RendererBase(getter.Count, (count-2)*3, count),
         Getter(getter),
+        Colors(colors),
         Marker(marker),
         Count(count),
         Size(size),
@@ -117,8 +206,8 @@ struct CustomRendererMarkersFill : RendererBase {
         UV = draw_list._Data->TexUvWhitePixel;
     }
     IMPLOT_INLINE bool Render(ImDrawList& draw_list, const ImRect& cull_rect, int prim) const {
-        ImVec2 p = this->Transformer(Getter(prim));
-        ImU32 col0 = ImGui::ColorConvertFloat4ToU32(colors[prim]);
+        ImVec2 p = pixelAt(this->Transformer, Getter, prim);
+        ImU32 col0 = Colors != nullptr ? Colors[prim] : Col;
         if (p.x >= cull_rect.Min.x && p.y >= cull_rect.Min.y && p.x <= cull_rect.Max.x && p.y <= cull_rect.Max.y) {
             for (int i = 0; i < Count; i++) {
                 draw_list._VtxWritePtr[0].pos.x = p.x + Marker[i].x * Size;
@@ -140,20 +229,20 @@ struct CustomRendererMarkersFill : RendererBase {
         return false;
     }
     const _Getter& Getter;
+    const ImU32* const Colors;
     const ImVec2* Marker;
     const int Count;
     const float Size;
     const ImU32 Col;
     mutable ImVec2 UV;
-
-    inline static ImVec4* colors;
 };
 
 template <class _Getter>
 struct CustomRendererMarkersLine : RendererBase {
-    CustomRendererMarkersLine(const _Getter& getter, const ImVec2* marker, int count, float size, float weight, ImU32 col) :
+    CustomRendererMarkersLine(const _Getter& getter, const ImU32* colors, const ImVec2* marker, int count, float size, float weight, ImU32 col) :
         RendererBase(getter.Count, count/2*6, count/2*4),
         Getter(getter),
+        Colors(colors),
         Marker(marker),
         Count(count),
         HalfWeight(ImMax(1.0f,weight)*0.5f),
@@ -164,8 +253,8 @@ struct CustomRendererMarkersLine : RendererBase {
         GetLineRenderProps(draw_list, HalfWeight, UV0, UV1);
     }
     IMPLOT_INLINE bool Render(ImDrawList& draw_list, const ImRect& cull_rect, int prim) const {
-        ImVec2 p = this->Transformer(Getter(prim));
-        ImU32 col0 = ImGui::ColorConvertFloat4ToU32(colors[prim]);
+        ImVec2 p = pixelAt(this->Transformer, Getter, prim);
+        ImU32 col0 = Colors != nullptr ? Colors[prim] : Col;
         if (p.x >= cull_rect.Min.x && p.y >= cull_rect.Min.y && p.x <= cull_rect.Max.x && p.y <= cull_rect.Max.y) {
             for (int i = 0; i < Count; i = i + 2) {
                 ImVec2 p1(p.x + Marker[i].x * Size, p.y + Marker[i].y * Size);
@@ -177,6 +266,7 @@ struct CustomRendererMarkersLine : RendererBase {
         return false;
     }
     const _Getter& Getter;
+    const ImU32* const Colors;
     const ImVec2* Marker;
     const int Count;
     mutable float HalfWeight;
@@ -184,96 +274,1330 @@ struct CustomRendererMarkersLine : RendererBase {
     const ImU32 Col;
     mutable ImVec2 UV0;
     mutable ImVec2 UV1;
-
-    inline static ImVec4* colors;
 };
 
+static int renderThreads = 1;
+
+// items with fewer primitives are not worth the synchronization
+static constexpr unsigned int PARALLEL_MIN_PRIMS = 100000;
+
+void setRenderThreads(int threads) {
+
+    renderThreads = ImMax(1, threads);
+    getThreadPool().resize(renderThreads - 1);
+}
+
+static bool useParallel(int prims) {
+
+    return renderThreads > 1 && prims >= (int)PARALLEL_MIN_PRIMS;
+}
+
+// draw lists of the chunks, which are reused between frames
+static std::vector<std::unique_ptr<ImDrawList>> chunkLists;
+
+/**
+ * Renders each renderer into its own chunk on the thread pool and then
+ * appends the chunks in order to the plot draw list.
+ */
+template <typename _Renderer>
+void renderChunksParallel(const std::vector<_Renderer>& renderers) {
+
+    ImDrawList& drawList = *GetPlotDrawList();
+    const ImRect& cullRect = GetCurrentPlot()->PlotRect;
+
+    int chunks = (int)renderers.size();
+
+    while ((int)chunkLists.size() < chunks) {
+        chunkLists.emplace_back(std::make_unique<ImDrawList>(drawList._Data));
+    }
+
+    // the imgui allocator is not thread-safe, so the chunk buffers
+    // are allocated here and the workers only write into them
+
+    for (int i = 0; i < chunks; ++i) {
+        ImDrawList& chunk = *chunkLists[i];
+        const _Renderer& renderer = renderers[i];
+        chunk._Data = drawList._Data;
+        chunk.Flags = drawList.Flags;
+        chunk.VtxBuffer.resize(renderer.Prims * renderer.VtxConsumed);
+        chunk.IdxBuffer.resize(renderer.Prims * renderer.IdxConsumed);
+        chunk._VtxWritePtr = chunk.VtxBuffer.Data;
+        chunk._IdxWritePtr = chunk.IdxBuffer.Data;
+        chunk._VtxCurrentIdx = 0;
+    }
+
+    getThreadPool().parallelFor(chunks, [&](int i) {
+        ImDrawList& chunk = *chunkLists[i];
+        const _Renderer& renderer = renderers[i];
+        renderer.Init(chunk);
+        for (unsigned int prim = 0; prim < renderer.Prims; ++prim) {
+            renderer.Render(chunk, cullRect, prim);
+        }
+    });
+
+    // splice, chunk indices start at zero and are shifted accordingly
+
+    for (int i = 0; i < chunks; ++i) {
+
+        ImDrawList& chunk = *chunkLists[i];
+
+        int vtxCount = (int)(chunk._VtxWritePtr - chunk.VtxBuffer.Data);
+        int idxCount = (int)(chunk._IdxWritePtr - chunk.IdxBuffer.Data);
+
+        if (vtxCount == 0) {
+            continue;
+        }
+
+        drawList.PrimReserve(idxCount, vtxCount);
+
+        unsigned int base = drawList._VtxCurrentIdx;
+
+        memcpy(drawList._VtxWritePtr, chunk.VtxBuffer.Data, vtxCount * sizeof(ImDrawVert));
+
+        for (int k = 0; k < idxCount; ++k) {
+            drawList._IdxWritePtr[k] = (ImDrawIdx)(chunk.IdxBuffer.Data[k] + base);
+        }
+
+        drawList._VtxWritePtr += vtxCount;
+        drawList._IdxWritePtr += idxCount;
+        drawList._VtxCurrentIdx += vtxCount;
+    }
+}
+
+/**
+ * Splits the points of a getter into chunks and renders them in parallel.
+ *
+ * Overlap is the number of points shared by consecutive chunks (1 for line
+ * strips). makeRenderer(slice, start) creates the renderer for the chunk
+ * starting at the given point. A chunk never exceeds the index range of
+ * ImDrawIdx, so that it can be appended with a single reservation.
+ */
+template <typename _Getter, typename F>
+void renderPrimitivesParallel(const _Getter& getter, int overlap, F&& makeRenderer) {
+
+    using Slice = GetterSlice<_Getter>;
+    using Renderer = decltype(makeRenderer(std::declval<const Slice&>(), 0));
+
+    Slice whole(getter, 0, getter.Count);
+    Renderer probe = makeRenderer(whole, 0);
+
+    int prims = (int)probe.Prims;
+    int maxChunk = (int)(MaxIdx<ImDrawIdx>::Value / probe.VtxConsumed);
+    int chunkPrims = ImMin(maxChunk, ImMax(1024, prims / (renderThreads * 4)));
+    int chunks = (prims + chunkPrims - 1) / chunkPrims;
+
+    std::vector<Slice> slices;
+    std::vector<Renderer> renderers;
+
+    slices.reserve(chunks);
+    renderers.reserve(chunks);
+
+    for (int i = 0; i < chunks; ++i) {
+        int start = i * chunkPrims;
+        int count = ImMin(chunkPrims, prims - start);
+        slices.emplace_back(getter, start, count + overlap);
+        renderers.push_back(makeRenderer(slices.back(), start));
+    }
+
+    renderChunksParallel(renderers);
+}
+
+/**
+ * Renders with per-point colors, in parallel if worthwhile.
+ */
+template <template <class> class _Renderer, class _Getter, typename ...Args>
+void RenderPrimitivesColored(const _Getter& getter, int overlap, const ImU32* colors, Args... args) {
+
+    if (useParallel(getter.Count)) {
+        renderPrimitivesParallel(getter, overlap, [&](const auto& slice, int start) {
+            using S = std::decay_t<decltype(slice)>;
+            return _Renderer<S>(slice, colors != nullptr ? colors + start : nullptr, args...);
+        });
+    } else {
+        RenderPrimitives1<_Renderer>(getter, colors, args...);
+    }
+}
+
+// pixel coordinates and segment offsets of linear plots
+static thread_local ImVector<float> pixelX;
+static thread_local ImVector<float> pixelY;
+static thread_local ImVector<float> offsetX;
+static thread_local ImVector<float> offsetY;
+
+// number of points gathered per call of the transform kernel
+static constexpr int TRANSFORM_BLOCK = 512;
+
+static bool linearAxisMap(const ImPlotAxis& axis, LinearAxisMap& map) {
+
+    if (axis.TransformForward != nullptr) {
+        return false;
+    }
+
+    map.pltMin = axis.Range.Min;
+    map.pixMin = axis.PixelMin;
+    map.scale = axis.ScaleToPixel;
+
+    return true;
+}
+
+/**
+ * Calls func with the points of the getter transformed to pixels by the
+ * simd kernels if both axes are linear, and with the getter otherwise.
+ *
+ * If halfWeight is positive, the quad offsets of the line segments are
+ * computed as well.
+ */
+template <typename _Getter, typename F>
+void withPixelGetter(const _Getter& getter, float halfWeight, F&& func) {
+
+    ImPlotPlot& plot = *GetCurrentPlot();
+
+    LinearAxisMap xMap;
+    LinearAxisMap yMap;
+
+    if (!linearAxisMap(plot.Axes[plot.CurrentX], xMap)
+            || !linearAxisMap(plot.Axes[plot.CurrentY], yMap)) {
+        func(getter);
+        return;
+    }
+
+    int count = getter.Count;
+
+    pixelX.resize(count);
+    pixelY.resize(count);
+
+    double xs[TRANSFORM_BLOCK];
+    double ys[TRANSFORM_BLOCK];
+
+    for (int start = 0; start < count; start += TRANSFORM_BLOCK) {
+        int n = ImMin(TRANSFORM_BLOCK, count - start);
+        for (int i = 0; i < n; ++i) {
+            ImPlotPoint p = getter(start + i);
+            xs[i] = p.x;
+            ys[i] = p.y;
+        }
+        transformLinear(xs, ys, n, xMap, yMap, pixelX.Data + start, pixelY.Data + start);
+    }
+
+    const float* ox = nullptr;
+    const float* oy = nullptr;
+
+    if (halfWeight > 0.0f && count > 1) {
+        offsetX.resize(count - 1);
+        offsetY.resize(count - 1);
+        computeLineOffsets(pixelX.Data, pixelY.Data, count, halfWeight, offsetX.Data, offsetY.Data);
+        ox = offsetX.Data;
+        oy = offsetY.Data;
+    }
+
+    func(GetterPixels(pixelX.Data, pixelY.Data, ox, oy, count));
+}
+
 template <typename _Getter>
-void CustomRenderMarkers(const _Getter& getter, ImPlotMarker marker, float size, bool rend_fill, ImU32 col_fill, bool rend_line, ImU32 col_line, float weight) {
+void CustomRenderMarkersEx(const _Getter& getter, const ImU32* colors, ImPlotMarker marker, float size, bool rend_fill, ImU32 col_fill, bool rend_line, ImU32 col_line, float weight) {
     if (rend_fill) {
         switch (marker) {
-            case ImPlotMarker_Circle  : RenderPrimitives1<CustomRendererMarkersFill>(getter,MARKER_FILL_CIRCLE,10,size,col_fill); break;
-            case ImPlotMarker_Square  : RenderPrimitives1<CustomRendererMarkersFill>(getter,MARKER_FILL_SQUARE, 4,size,col_fill); break;
-            case ImPlotMarker_Diamond : RenderPrimitives1<CustomRendererMarkersFill>(getter,MARKER_FILL_DIAMOND,4,size,col_fill); break;
-            case ImPlotMarker_Up      : RenderPrimitives1<CustomRendererMarkersFill>(getter,MARKER_FILL_UP,     3,size,col_fill); break;
-            case ImPlotMarker_Down    : RenderPrimitives1<CustomRendererMarkersFill>(getter,MARKER_FILL_DOWN,   3,size,col_fill); break;
-            case ImPlotMarker_Left    : RenderPrimitives1<CustomRendererMarkersFill>(getter,MARKER_FILL_LEFT,   3,size,col_fill); break;
-            case ImPlotMarker_Right   : RenderPrimitives1<CustomRendererMarkersFill>(getter,MARKER_FILL_RIGHT,  3,size,col_fill); break;
+            case ImPlotMarker_Circle  : RenderPrimitivesColored<CustomRendererMarkersFill>(getter,0,colors,MARKER_FILL_CIRCLE,10,size,col_fill); break;
+            case ImPlotMarker_Square  : RenderPrimitivesColored<CustomRendererMarkersFill>(getter,0,colors,MARKER_FILL_SQUARE, 4,size,col_fill); break;
+            case ImPlotMarker_Diamond : RenderPrimitivesColored<CustomRendererMarkersFill>(getter,0,colors,MARKER_FILL_DIAMOND,4,size,col_fill); break;
+            case ImPlotMarker_Up      : RenderPrimitivesColored<CustomRendererMarkersFill>(getter,0,colors,MARKER_FILL_UP,     3,size,col_fill); break;
+            case ImPlotMarker_Down    : RenderPrimitivesColored<CustomRendererMarkersFill>(getter,0,colors,MARKER_FILL_DOWN,   3,size,col_fill); break;
+            case ImPlotMarker_Left    : RenderPrimitivesColored<CustomRendererMarkersFill>(getter,0,colors,MARKER_FILL_LEFT,   3,size,col_fill); break;
+            case ImPlotMarker_Right   : RenderPrimitivesColored<CustomRendererMarkersFill>(getter,0,colors,MARKER_FILL_RIGHT,  3,size,col_fill); break;
         }
     }
     if (rend_line) {
         switch (marker) {
-            case ImPlotMarker_Circle    : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_CIRCLE, 20,size,weight,col_line); break;
-            case ImPlotMarker_Square    : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_SQUARE,  8,size,weight,col_line); break;
-            case ImPlotMarker_Diamond   : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_DIAMOND, 8,size,weight,col_line); break;
-            case ImPlotMarker_Up        : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_UP,      6,size,weight,col_line); break;
-            case ImPlotMarker_Down      : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_DOWN,    6,size,weight,col_line); break;
-            case ImPlotMarker_Left      : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_LEFT,    6,size,weight,col_line); break;
-            case ImPlotMarker_Right     : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_RIGHT,   6,size,weight,col_line); break;
-            case ImPlotMarker_Asterisk  : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_ASTERISK,6,size,weight,col_line); break;
-            case ImPlotMarker_Plus      : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_PLUS,    4,size,weight,col_line); break;
-            case ImPlotMarker_Cross     : RenderPrimitives1<CustomRendererMarkersLine>(getter,MARKER_LINE_CROSS,   4,size,weight,col_line); break;
+            case ImPlotMarker_Circle    : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_CIRCLE, 20,size,weight,col_line); break;
+            case ImPlotMarker_Square    : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_SQUARE,  8,size,weight,col_line); break;
+            case ImPlotMarker_Diamond   : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_DIAMOND, 8,size,weight,col_line); break;
+            case ImPlotMarker_Up        : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_UP,      6,size,weight,col_line); break;
+            case ImPlotMarker_Down      : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_DOWN,    6,size,weight,col_line); break;
+            case ImPlotMarker_Left      : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_LEFT,    6,size,weight,col_line); break;
+            case ImPlotMarker_Right     : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_RIGHT,   6,size,weight,col_line); break;
+            case ImPlotMarker_Asterisk  : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_ASTERISK,6,size,weight,col_line); break;
+            case ImPlotMarker_Plus      : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_PLUS,    4,size,weight,col_line); break;
+            case ImPlotMarker_Cross     : RenderPrimitivesColored<CustomRendererMarkersLine>(getter,0,colors,MARKER_LINE_CROSS,   4,size,weight,col_line); break;
         }
     }
 }
 
-void customPlot(
+template <typename _Getter>
+void CustomRenderMarkers(const _Getter& getter, const ImU32* colors, ImPlotMarker marker, float size, bool rend_fill, ImU32 col_fill, bool rend_line, ImU32 col_line, float weight) {
+    withPixelGetter(getter, 0.0f, [&](const auto& pixelGetter) {
+        CustomRenderMarkersEx(pixelGetter, colors, marker, size, rend_fill, col_fill, rend_line, col_line, weight);
+    });
+}
+
+/**
+ * Renders a line strip with optional per-point colors.
+ */
+template <typename _Getter>
+void renderLineStrip(const _Getter& getter, const ImU32* colors, ImU32 col, float weight) {
+    // the offsets must include the widening of anti-aliased lines
+    float halfWeight = ImMax(1.0f, weight) * 0.5f;
+    ImVec2 uv0, uv1;
+    GetLineRenderProps(*GetPlotDrawList(), halfWeight, uv0, uv1);
+    withPixelGetter(getter, halfWeight, [&](const auto& pixelGetter) {
+        RenderPrimitivesColored<CustomRendererLineStrip>(pixelGetter, 1, colors, col, weight);
+    });
+}
+
+/**
+ * Indexes arbitrarily strided data (e.g. numpy views) without wrap-around.
+ * In contrast to IndexerIdx negative strides are allowed.
+ */
+template <typename T>
+struct IndexerStrided {
+    IndexerStrided(const void* data, int count, ptrdiff_t stride) :
+        Data((const unsigned char*)data),
+        Count(count),
+        Stride(stride)
+    { }
+    template <typename I> IMPLOT_INLINE double operator()(I idx) const {
+        return (double)*(const T*)(Data + (ptrdiff_t)idx * Stride);
+    }
+    const unsigned char* Data;
+    int Count;
+    ptrdiff_t Stride;
+};
+
+/**
+ * Like IndexerStrided, but for ring buffers. Index 0 maps to the element
+ * at the given offset and indices wrap around at the capacity.
+ */
+template <typename T>
+struct IndexerRing {
+    IndexerRing(const void* data, int count, ptrdiff_t stride, int offset, int capacity) :
+        Data((const unsigned char*)data),
+        Count(count),
+        Stride(stride),
+        Offset(offset),
+        Capacity(capacity)
+    { }
+    template <typename I> IMPLOT_INLINE double operator()(I idx) const {
+        int i = Offset + (int)idx;
+        if (i >= Capacity) {
+            i -= Capacity;
+        }
+        return (double)*(const T*)(Data + (ptrdiff_t)i * Stride);
+    }
+    const unsigned char* Data;
+    int Count;
+    ptrdiff_t Stride;
+    int Offset;
+    int Capacity;
+};
+
+/**
+ * Creates indexers for the natively typed plot arrays and passes them to func.
+ */
+template <typename F>
+void withPlotIndexers(PlotArrayInfo& pai, F&& func) {
+
+    int count = (int)pai.count;
+
+    dispatchDataType(pai.dataType, [&](auto tag) {
+        using T = decltype(tag);
+        if (pai.ringCapacity > 0) {
+            int offset = (int)pai.ringOffset;
+            int capacity = (int)pai.ringCapacity;
+            IndexerRing<T> yIndexer(pai.yDataPtr, count, pai.yStride, offset, capacity);
+            if (pai.implicitX) {
+                func(IndexerLin(pai.xScale, pai.xStart), yIndexer);
+            } else {
+                func(IndexerRing<T>(pai.xDataPtr, count, pai.xStride, offset, capacity),
+                     yIndexer);
+            }
+            return;
+        }
+        IndexerStrided<T> yIndexer(pai.yDataPtr, count, pai.yStride);
+        if (pai.implicitX) {
+            func(IndexerLin(pai.xScale, pai.xStart), yIndexer);
+        } else {
+            func(IndexerStrided<T>(pai.xDataPtr, count, pai.xStride), yIndexer);
+        }
+    });
+}
+
+/**
+ * Range of the finite values of one plot array, ring buffers are reduced
+ * in their two contiguous parts.
+ */
+static ImPlotRange arrayRange(const PlotArrayInfo& pai, const void* data, ptrdiff_t stride) {
+
+    ImPlotRange range(HUGE_VAL, -HUGE_VAL);
+
+    dispatchDataType(pai.dataType, [&](auto tag) {
+        using T = decltype(tag);
+        if (pai.ringCapacity > 0) {
+            size_t first = std::min(pai.count, pai.ringCapacity - pai.ringOffset);
+            const uint8_t* start = (const uint8_t*)data + (ptrdiff_t)pai.ringOffset * stride;
+            extendFiniteRange<T>(range, start, first, stride);
+            extendFiniteRange<T>(range, data, pai.count - first, stride);
+        } else {
+            extendFiniteRange<T>(range, data, pai.count, stride);
+        }
+    });
+
+    return range;
+}
+
+/**
+ * Bounds of the finite values of the plot arrays. These are either given
+ * with the arrays or computed by a branch free min/max reduction.
+ */
+static ImPlotRect plotBounds(const PlotArrayInfo& pai) {
+
+    if (pai.hasBounds) {
+        return pai.bounds;
+    }
+
+    ImPlotRect bounds;
+
+    if (pai.implicitX) {
+        double last = pai.xStart + pai.xScale * (double)(pai.count - 1);
+        bounds.X = ImPlotRange(ImMin(pai.xStart, last), ImMax(pai.xStart, last));
+    } else {
+        bounds.X = arrayRange(pai, pai.xDataPtr, pai.xStride);
+    }
+
+    bounds.Y = arrayRange(pai, pai.yDataPtr, pai.yStride);
+
+    return bounds;
+}
+
+/**
+ * Wraps the getter of plot arrays, so that fitting can use their bounds
+ * instead of visiting every point (see the Fitter1 specialization below).
+ */
+template <typename _Getter>
+struct GetterBounded {
+    GetterBounded(const _Getter& getter, const PlotArrayInfo& info) :
+        Getter(getter),
+        Info(info),
+        Count(getter.Count)
+    { }
+    template <typename I> IMPLOT_INLINE ImPlotPoint operator()(I idx) const {
+        return Getter(idx);
+    }
+    const _Getter Getter;
+    const PlotArrayInfo& Info;
+    const int Count;
+};
+
+/**
+ * ExtendFit drops values outside of the constraint range, which log and
+ * time axes always have. The extremes of the data are then not the
+ * extremes of the fit, so bounds are only used for unconstrained linear
+ * axes without RangeFit.
+ */
+static bool boundsFitAllowed(const ImPlotAxis& axis) {
+
+    return axis.Scale == ImPlotScale_Linear
+        && !ImHasFlag(axis.Flags, ImPlotAxisFlags_RangeFit)
+        && axis.ConstraintRange.Min <= -DBL_MAX
+        && axis.ConstraintRange.Max >= DBL_MAX;
+}
+
+/**
+ * Used by BeginItemEx in the stock and custom plot functions alike.
+ *
+ * With RangeFit, the points to fit depend on the range of the other axis,
+ * and constrained axes filter every point, so these are still visited
+ * one by one.
+ */
+template <typename _Getter>
+struct Fitter1<GetterBounded<_Getter>> {
+    Fitter1(const GetterBounded<_Getter>& getter) : Getter(getter) { }
+    void Fit(ImPlotAxis& x_axis, ImPlotAxis& y_axis) const {
+        if (Getter.Count == 0) {
+            return;
+        }
+        if (!boundsFitAllowed(x_axis) || !boundsFitAllowed(y_axis)) {
+            Fitter1<_Getter>(Getter.Getter).Fit(x_axis, y_axis);
+            return;
+        }
+        ImPlotRect bounds = plotBounds(Getter.Info);
+        if (bounds.X.Min <= bounds.X.Max) {
+            x_axis.ExtendFit(bounds.X.Min);
+            x_axis.ExtendFit(bounds.X.Max);
+        }
+        if (bounds.Y.Min <= bounds.Y.Max) {
+            y_axis.ExtendFit(bounds.Y.Min);
+            y_axis.ExtendFit(bounds.Y.Max);
+        }
+    }
+    const GetterBounded<_Getter>& Getter;
+};
+
+/**
+ * Creates a getter for the natively typed plot arrays and passes it to func.
+ */
+template <typename F>
+void withPlotGetter(PlotArrayInfo& pai, F&& func) {
+
+    withPlotIndexers(pai, [&](const auto& xIndexer, const auto& yIndexer) {
+        using IX = std::decay_t<decltype(xIndexer)>;
+        using IY = std::decay_t<decltype(yIndexer)>;
+        GetterXY<IX, IY> points(xIndexer, yIndexer, (int)pai.count);
+        GetterBounded<GetterXY<IX, IY>> getter(points, pai);
+        func(getter);
+    });
+}
+
+/**
+ * Maps the indices of a reduced point set to the points of the original getter.
+ */
+template <typename _Getter>
+struct GetterIndexed {
+    GetterIndexed(const _Getter& getter, const int* indices, int count) :
+        Getter(getter),
+        Indices(indices),
+        Count(count)
+    { }
+    template <typename I> IMPLOT_INLINE ImPlotPoint operator()(I idx) const {
+        return Getter(Indices[idx]);
+    }
+    const _Getter& Getter;
+    const int* const Indices;
+    const int Count;
+};
+
+/**
+ * The reduced points of a level-of-detail line are fit like the points
+ * they were reduced from, so that fitting does not depend on the view.
+ */
+template <typename _Getter>
+struct Fitter1<GetterIndexed<GetterBounded<_Getter>>> {
+    Fitter1(const GetterIndexed<GetterBounded<_Getter>>& getter) : Getter(getter) { }
+    void Fit(ImPlotAxis& x_axis, ImPlotAxis& y_axis) const {
+        Fitter1<GetterBounded<_Getter>>(Getter.Getter).Fit(x_axis, y_axis);
+    }
+    const GetterIndexed<GetterBounded<_Getter>>& Getter;
+};
+
+/**
+ * Level-of-detail reduction for line plots (M4 aggregation).
+ *
+ * Consecutive points falling into the same pixel column are reduced to the
+ * first, minimum, maximum and last point of that column. A line through the
+ * remaining points covers the same pixels as a line through all points.
+ */
+template <typename _Getter>
+void decimateM4(const _Getter& getter, ImVector<int>& indices) {
+
+    indices.resize(0);
+
+    const int count = getter.Count;
+    if (count <= 0) {
+        return;
+    }
+
+    Transformer2 transformer;
+
+    ImPlotPoint p = getter(0);
+    float column = std::floor(transformer.Tx(p.x));
+
+    int first = 0;
+    int minIdx = 0;
+    int maxIdx = 0;
+    double minY = p.y;
+    double maxY = p.y;
+
+    for (int i = 1; i <= count; ++i) {
+
+        float c = 0.0f;
+
+        if (i < count) {
+            p = getter(i);
+            c = std::floor(transformer.Tx(p.x));
+            if (c == column) {
+                if (p.y < minY) {
+                    minY = p.y;
+                    minIdx = i;
+                }
+                if (p.y > maxY) {
+                    maxY = p.y;
+                    maxIdx = i;
+                }
+                continue;
+            }
+        }
+
+        // emit the finished column in index order
+
+        const int candidates[4] = {
+            first, ImMin(minIdx, maxIdx), ImMax(minIdx, maxIdx), i - 1
+        };
+
+        int prev = -1;
+        for (int k : candidates) {
+            if (k != prev) {
+                indices.push_back(k);
+                prev = k;
+            }
+        }
+
+        first = i;
+        minIdx = i;
+        maxIdx = i;
+        minY = p.y;
+        maxY = p.y;
+        column = c;
+    }
+}
+
+// scratch buffers are per thread, so that plots can be built concurrently
+static thread_local ImVector<int> lodIndices;
+static thread_local ImVector<ImU32> lodColors;
+
+/**
+ * Decimation only pays off if there are more points than pixel columns.
+ */
+static bool useLod(int count, ImPlotLineFlags flags) {
+
+    ImPlotPlot* plot = GetCurrentPlot();
+
+    if (plot == nullptr || ImHasFlag(flags, ImPlotLineFlags_Segments)) {
+        return false;
+    }
+
+    // ensures that the pixel transformation is up-to-date
+    SetupLock();
+
+    return count > 4 * (int)plot->PlotRect.GetWidth();
+}
+
+/**
+ * Finds the range of points, which is visible on the current x-axis.
+ *
+ * This is a binary search and therefore requires monotonic x-values.
+ * One additional point is kept on each side, so that lines leaving the
+ * plot area are still drawn. Returns false if nothing can be culled.
+ */
+template <typename _Getter>
+bool findVisibleRange(const _Getter& getter, int& start, int& count) {
+
+    ImPlotPlot* plot = GetCurrentPlot();
+
+    if (plot == nullptr || getter.Count < 3) {
+        return false;
+    }
+
+    SetupLock();
+
+    const ImPlotRange& range = plot->Axes[plot->CurrentX].Range;
+    const bool ascending = getter(0).x <= getter(getter.Count - 1).x;
+
+    // first index with x "behind" the given value (upper bound)
+    auto upperBound = [&](double value, bool inclusive) {
+        int lo = 0;
+        int hi = getter.Count;
+        while (lo < hi) {
+            int mid = lo + (hi - lo) / 2;
+            double x = getter(mid).x;
+            bool before = ascending
+                ? (inclusive ? x <= value : x < value)
+                : (inclusive ? x >= value : x > value);
+            if (before) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo;
+    };
+
+    int begin = 0;
+    int end = 0;
+
+    if (ascending) {
+        begin = upperBound(range.Min, false) - 1;
+        end = upperBound(range.Max, true) + 1;
+    } else {
+        begin = upperBound(range.Max, false) - 1;
+        end = upperBound(range.Min, true) + 1;
+    }
+
+    begin = ImClamp(begin, 0, getter.Count);
+    end = ImClamp(end, begin, getter.Count);
+
+    if (begin == 0 && end == getter.Count) {
+        return false;
+    }
+
+    start = begin;
+    count = end - begin;
+
+    return true;
+}
+
+/**
+ * The stock implot functions fit to the points of the getter they render.
+ * Culling is therefore only allowed if the fit does not depend on the
+ * invisible points.
+ */
+static bool cullingAllowed() {
+
+    ImPlotPlot* plot = GetCurrentPlot();
+
+    if (plot == nullptr) {
+        return false;
+    }
+
+    SetupLock();
+
+    const ImPlotAxis& xAxis = plot->Axes[plot->CurrentX];
+    const ImPlotAxis& yAxis = plot->Axes[plot->CurrentY];
+
+    return !xAxis.FitThisFrame
+        && (!yAxis.FitThisFrame || ImHasFlag(yAxis.Flags, ImPlotAxisFlags_RangeFit));
+}
+
+/**
+ * Calls func with the getter or, if possible, with the visible slice of it.
+ */
+template <typename _Getter, typename F>
+void withVisibleGetter(const _Getter& getter, bool monotonic, F&& func) {
+
+    int start = 0;
+    int count = 0;
+
+    if (monotonic && cullingAllowed() && findVisibleRange(getter, start, count)) {
+        func(GetterSlice<_Getter>(getter, start, count));
+    } else {
+        func(getter);
+    }
+}
+
+/**
+ * Plot arrays fit to their bounds on unconstrained linear axes, which do
+ * not depend on the visible points. Culling is then also possible while
+ * fitting, which keeps the NaN search and LOD limited to visible points.
+ */
+template <typename _Getter, typename F>
+void withVisibleGetter(const GetterBounded<_Getter>& getter, bool monotonic, F&& func) {
+
+    ImPlotPlot* plot = GetCurrentPlot();
+
+    if (plot != nullptr) {
+        SetupLock();
+    }
+
+    bool boundsFit = plot != nullptr
+        && boundsFitAllowed(plot->Axes[plot->CurrentX])
+        && boundsFitAllowed(plot->Axes[plot->CurrentY]);
+
+    int start = 0;
+    int count = 0;
+
+    if (monotonic
+            && (boundsFit || cullingAllowed())
+            && findVisibleRange(getter, start, count)) {
+        GetterSlice<_Getter> slice(getter.Getter, start, count);
+        func(GetterBounded<GetterSlice<_Getter>>(slice, getter.Info));
+    } else {
+        func(getter);
+    }
+}
+
+// scratch buffers of the finite runs, see withFiniteRuns
+static thread_local ImVector<int> finiteRuns;
+static thread_local ImVector<int> finiteIndices;
+static thread_local ImVector<ImU32> finiteColors;
+
+/**
+ * Finds the contiguous runs of points with finite coordinates and stores
+ * them as (start, count) pairs. Returns true if all points are finite.
+ */
+template <typename _Getter>
+bool findFiniteRuns(const _Getter& getter, ImVector<int>& runs) {
+
+    runs.resize(0);
+
+    int start = -1;
+
+    for (int i = 0; i < getter.Count; ++i) {
+        ImPlotPoint p = getter(i);
+        bool finite = isFiniteValue(p.x) && isFiniteValue(p.y);
+        if (finite && start < 0) {
+            start = i;
+        } else if (!finite && start >= 0) {
+            runs.push_back(start);
+            runs.push_back(i - start);
+            start = -1;
+        }
+    }
+
+    if (start >= 0) {
+        runs.push_back(start);
+        runs.push_back(getter.Count - start);
+    }
+
+    return runs.Size == 2 && runs[0] == 0 && runs[1] == getter.Count;
+}
+
+/**
+ * Integer arrays cannot contain NaN, ring buffers know it from their
+ * block summaries.
+ */
+static bool knownFinite(const PlotArrayInfo& pai) {
+
+    return pai.finite
+        || (pai.dataType != PlotDataType::Float32 && pai.dataType != PlotDataType::Float64);
+}
+
+/**
+ * Calls func(run, start, indices) for the parts of a line, which are
+ * separated by non-finite points. The renderers therefore need no check
+ * per point. The getter should already be culled to the visible points,
+ * so that the search costs no more than rendering them.
+ *
+ * Each run is drawn as a strip of its own, so that NaN points leave gaps.
+ * With skipNaN, the finite points are connected into a single run, which
+ * is given by indices into the getter. Otherwise run point i is getter
+ * point start + i and indices is null.
+ */
+template <typename _Getter, typename F>
+void withFiniteRuns(const _Getter& getter, bool finite, bool skipNaN, F&& func) {
+
+    if (finite || findFiniteRuns(getter, finiteRuns)) {
+        func(GetterSlice<_Getter>(getter, 0, getter.Count), 0, (const int*)nullptr);
+        return;
+    }
+
+    if (skipNaN) {
+        finiteIndices.resize(0);
+        for (int r = 0; r < finiteRuns.Size; r += 2) {
+            for (int i = 0; i < finiteRuns[r + 1]; ++i) {
+                finiteIndices.push_back(finiteRuns[r] + i);
+            }
+        }
+        func(GetterIndexed<_Getter>(getter, finiteIndices.Data, finiteIndices.Size),
+             0,
+             (const int*)finiteIndices.Data);
+        return;
+    }
+
+    for (int r = 0; r < finiteRuns.Size; r += 2) {
+        func(GetterSlice<_Getter>(getter, finiteRuns[r], finiteRuns[r + 1]),
+             finiteRuns[r],
+             (const int*)nullptr);
+    }
+}
+
+/**
+ * Renders the line and markers of a run with the style of the current item.
+ */
+template <typename _Getter>
+void renderLineItem(const _Getter& getter) {
+
+    const ImPlotNextItemData& s = GetItemData();
+
+    if (getter.Count > 1 && s.RenderLine) {
+        const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_Line]);
+        renderLineStrip(getter, nullptr, col_line, s.LineWeight);
+    }
+    // render markers
+    if (s.Marker != ImPlotMarker_None) {
+        const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerOutline]);
+        const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerFill]);
+        CustomRenderMarkers<_Getter>(
+                getter,
+                nullptr,
+                s.Marker,
+                s.MarkerSize,
+                s.RenderMarkerFill,
+                col_fill,
+                s.RenderMarkerLine,
+                col_line,
+                s.MarkerWeight);
+    }
+}
+
+/**
+ * PlotLineEx for plain line strips, which uses the simd kernels on linear
+ * axes and generates the vertices of large items in parallel.
+ * NaN points are handled by splitting the line into finite runs.
+ */
+template <typename _Getter>
+void PlotLineFastEx(const char* label_id, const _Getter& getter, ImPlotLineFlags flags, bool lod, bool finite) {
+
+    if (BeginItemEx(label_id, Fitter1<_Getter>(getter), flags, ImPlotCol_Line)) {
+
+        bool skipNaN = ImHasFlag(flags, ImPlotLineFlags_SkipNaN);
+
+        withFiniteRuns(getter, finite, skipNaN, [&](const auto& run, int, const int*) {
+            using R = std::decay_t<decltype(run)>;
+            if (lod && useLod(run.Count, flags)) {
+                decimateM4(run, lodIndices);
+                renderLineItem(GetterIndexed<R>(run, lodIndices.Data, lodIndices.Size));
+            } else {
+                renderLineItem(run);
+            }
+        });
+
+        EndItem();
+    }
+}
+
+void plotLine(
+        const char* label,
+        PlotArrayInfo& pai,
+        ImPlotLineFlags flags,
+        bool lod) {
+
+    // these are handled by the stock renderers only, NoClip needs the
+    // clip rect of the markers to be widened
+    const ImPlotLineFlags stockFlags = ImPlotLineFlags_Segments
+        | ImPlotLineFlags_Loop
+        | ImPlotLineFlags_Shaded
+        | ImPlotLineFlags_NoClip;
+
+    bool fast = (flags & stockFlags) == 0;
+
+    // the closing segment of loops would be culled
+    bool monotonic = pai.monotonicX && !ImHasFlag(flags, ImPlotLineFlags_Loop);
+
+    withPlotGetter(pai, [&](auto& fullGetter) {
+        withVisibleGetter(fullGetter, monotonic, [&](const auto& getter) {
+            using G = std::decay_t<decltype(getter)>;
+            if (fast) {
+                PlotLineFastEx(label, getter, flags, lod, knownFinite(pai));
+            } else if (lod && useLod(getter.Count, flags)) {
+                decimateM4(getter, lodIndices);
+                PlotLineEx(label, GetterIndexed<G>(getter, lodIndices.Data, lodIndices.Size), flags);
+            } else {
+                PlotLineEx(label, getter, flags);
+            }
+        });
+    });
+}
+
+void plotScatter(
+        const char* label,
+        PlotArrayInfo& pai,
+        ImPlotScatterFlags flags) {
+
+    withPlotGetter(pai, [&](auto& fullGetter) {
+        withVisibleGetter(fullGetter, pai.monotonicX, [&](const auto& getter) {
+            PlotScatterEx(label, getter, flags);
+        });
+    });
+}
+
+void plotBars(
+        const char* label,
+        PlotArrayInfo& pai,
+        double barSize,
+        ImPlotBarsFlags flags) {
+
+    withPlotGetter(pai, [&](auto& getter) {
+        using G = std::decay_t<decltype(getter)>;
+        if (ImHasFlag(flags, ImPlotBarsFlags_Horizontal)) {
+            PlotBarsHEx(label, getter, GetterOverrideX<G>(getter, 0), barSize, flags);
+        } else {
+            PlotBarsVEx(label, getter, GetterOverrideY<G>(getter, 0), barSize, flags);
+        }
+    });
+}
+
+/**
+ * Adds an offset indexer, scaled by sign, to the values of another indexer.
+ */
+template <typename _IndexerY, typename _IndexerOffset>
+struct IndexerShifted {
+    IndexerShifted(const _IndexerY& y, const _IndexerOffset& offset, double sign) :
+        Y(y),
+        Offset(offset),
+        Sign(sign)
+    { }
+    template <typename I> IMPLOT_INLINE double operator()(I idx) const {
+        return Y(idx) + Sign * Offset(idx);
+    }
+    const _IndexerY Y;
+    const _IndexerOffset Offset;
+    const double Sign;
+};
+
+void plotShaded(
         const char* label,
         PlotArrayInfo& pai,
-        py::handle color,
+        PlotBandInfo& band,
+        ImPlotShadedFlags flags) {
+
+    int count = (int)std::min(band.count, pai.count);
+
+    IndexerStrided<double> lower(band.lowerDataPtr, count, band.lowerStride);
+    IndexerStrided<double> upper(band.upperDataPtr, count, band.upperStride);
+
+    withPlotIndexers(pai, [&](const auto& xIndexer, const auto& yIndexer) {
+        using IX = std::decay_t<decltype(xIndexer)>;
+        using IY = std::decay_t<decltype(yIndexer)>;
+        if (band.relative) {
+            using IS = IndexerShifted<IY, IndexerStrided<double>>;
+            GetterXY<IX, IS> getter1(xIndexer, IS(yIndexer, lower, -1.0), count);
+            GetterXY<IX, IS> getter2(xIndexer, IS(yIndexer, upper, 1.0), count);
+            PlotShadedEx(label, getter1, getter2, flags);
+        } else {
+            using IB = IndexerStrided<double>;
+            GetterXY<IX, IB> getter1(xIndexer, lower, count);
+            GetterXY<IX, IB> getter2(xIndexer, upper, count);
+            PlotShadedEx(label, getter1, getter2, flags);
+        }
+    });
+}
+
+/**
+ * Size of the lookup table for colormapped point colors.
+ */
+static constexpr int COLOR_LUT_SIZE = 256;
+
+static thread_local ImVector<ImU32> colorBuffer;
+
+/**
+ * Returns packed colors for the points [start, start + count).
+ *
+ * Contiguous packed colors are used in place, all others are converted
+ * into a buffer, which is valid until the next call.
+ */
+static const ImU32* resolveColors(const PlotColorInfo& pci, int start, int count) {
+
+    const unsigned char* data = (const unsigned char*)pci.dataPtr
+        + (ptrdiff_t)start * pci.stride;
+
+    if (pci.type == PlotColorType::Packed && pci.stride == sizeof(ImU32)) {
+        return (const ImU32*)data;
+    }
+
+    colorBuffer.resize(count);
+
+    if (pci.type == PlotColorType::Packed) {
+        for (int i = 0; i < count; ++i) {
+            colorBuffer[i] = *(const ImU32*)(data + (ptrdiff_t)i * pci.stride);
+        }
+    } else if (pci.type == PlotColorType::Float4) {
+        for (int i = 0; i < count; ++i) {
+            const ImVec4& c = *(const ImVec4*)(data + (ptrdiff_t)i * pci.stride);
+            colorBuffer[i] = ImGui::ColorConvertFloat4ToU32(c);
+        }
+    } else if (pci.type == PlotColorType::Mapped) {
+
+        ImU32 lut[COLOR_LUT_SIZE];
+        for (int i = 0; i < COLOR_LUT_SIZE; ++i) {
+            float t = (float)i / (float)(COLOR_LUT_SIZE - 1);
+            lut[i] = ImGui::ColorConvertFloat4ToU32(SampleColormap(t, pci.colormap));
+        }
+
+        double range = pci.valueMax - pci.valueMin;
+        double scale = range != 0.0 ? (COLOR_LUT_SIZE - 1) / range : 0.0;
+
+        dispatchDataType(pci.valueType, [&](auto tag) {
+            using T = decltype(tag);
+            IndexerStrided<T> values(data, count, pci.stride);
+            for (int i = 0; i < count; ++i) {
+                double v = values(i);
+                // NaN has no defined lookup index, so such points are hidden
+                if (!isFiniteValue(v)) {
+                    colorBuffer[i] = IM_COL32(0, 0, 0, 0);
+                    continue;
+                }
+                double t = (v - pci.valueMin) * scale;
+                int idx = (int)ImClamp(t, 0.0, (double)(COLOR_LUT_SIZE - 1));
+                colorBuffer[i] = lut[idx];
+            }
+        });
+    }
+
+    return colorBuffer.Data;
+}
+
+template <typename _Getter>
+void customRender(
+        const _Getter& getter,
+        const ImU32* colors,
         bool noLine,
-        ImPlotFlags flags) {
+        ImPlotFlags flags,
+        bool lod) {
 
-    GetterXY<IndexerIdx<double>, IndexerIdx<double>> getter(
-             IndexerIdx<double>(pai.xDataPtr, pai.count, 0, sizeof(double)),
-             IndexerIdx<double>(pai.yDataPtr, pai.count, 0, sizeof(double)),
-             pai.count);
+    const ImPlotNextItemData& s = ImPlot::GetItemData();
+
+    if (getter.Count > 1 && s.RenderLine && noLine == false) {
+        const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_Line]);
+        if (lod && useLod(getter.Count, flags)) {
+            decimateM4(getter, lodIndices);
+            lodColors.resize(lodIndices.Size);
+            for (int i = 0; i < lodIndices.Size; ++i) {
+                lodColors[i] = colors[lodIndices[i]];
+            }
+            renderLineStrip(
+                    GetterIndexed<_Getter>(getter, lodIndices.Data, lodIndices.Size),
+                    lodColors.Data,
+                    col_line,
+                    s.LineWeight);
+        } else {
+            renderLineStrip(getter, colors, col_line, s.LineWeight);
+        }
+    }
+    // render markers
+    if (s.Marker != ImPlotMarker_None) {
+        const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerOutline]);
+        const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerFill]);
+        CustomRenderMarkers<_Getter>(
+                getter,
+                colors,
+                s.Marker,
+                s.MarkerSize,
+                s.RenderMarkerFill, 
+                col_fill,
+                s.RenderMarkerLine,
+                col_line,
+                s.MarkerWeight);
+    }
+}
+
+template <typename _Getter>
+void customPlotEx(
+        const char* label,
+        const _Getter& getter,
+        size_t count,
+        const PlotColorInfo& colors,
+        bool noLine,
+        ImPlotFlags flags,
+        bool lod,
+        bool monotonic,
+        bool finite) {
 
     if (BeginItemEx(
                 label,
-                Fitter1(getter),
+                Fitter1<_Getter>(getter),
                 flags,
                 ImPlotCol_Line)) {
 
-        array_like<float> colArr = array_like<float>::ensure(color);
-
-        if ((size_t)colArr.shape(0) != pai.count) {
+        if (colors.count != count) {
             std::stringstream ss;
             ss << "color array size ("
-               << colArr.shape(0)
+               << colors.count
                << ") != number of points ("
-               << pai.count
+               << count
                << ")";
             throw py::value_error(ss.str());
         }
 
-        CustomRendererLineStrip<decltype(getter)>::colors = (ImVec4*)colArr.mutable_data(0);
-        CustomRendererMarkersFill<decltype(getter)>::colors = (ImVec4*)colArr.mutable_data(0);
-        CustomRendererMarkersLine<decltype(getter)>::colors = (ImVec4*)colArr.mutable_data(0);
+        bool skipNaN = ImHasFlag(flags, ImPlotLineFlags_SkipNaN);
 
-        const ImPlotNextItemData& s = ImPlot::GetItemData();
+        auto renderRuns = [&](const auto& points, const ImU32* pointColors) {
+            withFiniteRuns(points, finite, skipNaN, [&](const auto& run, int runStart, const int* indices) {
+                const ImU32* runColors = pointColors + runStart;
+                if (indices != nullptr) {
+                    finiteColors.resize(run.Count);
+                    for (int i = 0; i < run.Count; ++i) {
+                        finiteColors[i] = pointColors[indices[i]];
+                    }
+                    runColors = finiteColors.Data;
+                }
+                customRender(run, runColors, noLine, flags, lod);
+            });
+        };
 
-        if (pai.count > 1 && s.RenderLine && noLine == false) {
-            const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_Line]);
-            RenderPrimitives1<CustomRendererLineStrip>(getter, col_line, s.LineWeight);
-        }
-        // render markers
-        if (s.Marker != ImPlotMarker_None) {
-            const ImU32 col_line = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerOutline]);
-            const ImU32 col_fill = ImGui::GetColorU32(s.Colors[ImPlotCol_MarkerFill]);
-            CustomRenderMarkers<decltype(getter)>(
-                    getter,
-                    s.Marker,
-                    s.MarkerSize,
-                    s.RenderMarkerFill, 
-                    col_fill,
-                    s.RenderMarkerLine,
-                    col_line,
-                    s.MarkerWeight);
+        // fitting is already done, so culling is always possible here
+        // and colors are only resolved for the visible points
+
+        int start = 0;
+        int visible = 0;
+
+        if (monotonic && findVisibleRange(getter, start, visible)) {
+            GetterSlice<_Getter> slice(getter, start, visible);
+            renderRuns(slice, resolveColors(colors, start, visible));
+        } else {
+            renderRuns(getter, resolveColors(colors, 0, getter.Count));
         }
         
         ImPlot::EndItem();
     }
 }
 
+void customPlot(
+        const char* label,
+        PlotArrayInfo& pai,
+        const PlotColorInfo& colors,
+        bool noLine,
+        ImPlotFlags flags,
+        bool lod) {
+
+    withPlotGetter(pai, [&](auto& getter) {
+        customPlotEx(label, getter, pai.count, colors, noLine, flags, lod, pai.monotonicX, knownFinite(pai));
+    });
+}
+
+
+/**
+ * Triangle fans of convex polygons, colored per polygon.
+ */
+template <typename _Getter>
+void renderPolygonFills(
+        const _Getter& getter,
+        int polygonCount,
+        int vertexCount,
+        const ImU32* colors,
+        ImU32 col) {
+
+    ImDrawList& drawList = *GetPlotDrawList();
+    const ImRect& cullRect = GetCurrentPlot()->PlotRect;
+    Transformer2 transformer;
+
+    const ImVec2 uv = drawList._Data->TexUvWhitePixel;
+    const int idxCount = (vertexCount - 2) * 3;
+
+    drawList.PrimReserve(polygonCount * idxCount, polygonCount * vertexCount);
+
+    int culled = 0;
+
+    for (int p = 0; p < polygonCount; ++p) {
+
+        ImDrawVert* vtx = drawList._VtxWritePtr;
+        ImRect bounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+        ImU32 c = colors != nullptr ? colors[p] : col;
+
+        for (int i = 0; i < vertexCount; ++i) {
+            ImVec2 pos = pixelAt(transformer, getter, p * vertexCount + i);
+            bounds.Add(pos);
+            vtx[i].pos = pos;
+            vtx[i].uv = uv;
+            vtx[i].col = c;
+        }
+
+        if (!cullRect.Overlaps(bounds)) {
+            culled++;
+            continue;
+        }
+
+        for (int i = 2; i < vertexCount; ++i) {
+            drawList._IdxWritePtr[0] = (ImDrawIdx)(drawList._VtxCurrentIdx);
+            drawList._IdxWritePtr[1] = (ImDrawIdx)(drawList._VtxCurrentIdx + i - 1);
+            drawList._IdxWritePtr[2] = (ImDrawIdx)(drawList._VtxCurrentIdx + i);
+            drawList._IdxWritePtr += 3;
+        }
+
+        drawList._VtxWritePtr += vertexCount;
+        drawList._VtxCurrentIdx += vertexCount;
+    }
+
+    drawList.PrimUnreserve(culled * idxCount, culled * vertexCount);
+}
+
+/**
+ * Closed outlines of polygons, colored per polygon.
+ */
+template <typename _Getter>
+void renderPolygonOutlines(
+        const _Getter& getter,
+        int polygonCount,
+        int vertexCount,
+        const ImU32* colors,
+        ImU32 col,
+        float weight) {
+
+    ImDrawList& drawList = *GetPlotDrawList();
+    const ImRect& cullRect = GetCurrentPlot()->PlotRect;
+    Transformer2 transformer;
+
+    float halfWeight = ImMax(1.0f, weight) * 0.5f;
+    ImVec2 uv0, uv1;
+    GetLineRenderProps(drawList, halfWeight, uv0, uv1);
+
+    drawList.PrimReserve(polygonCount * vertexCount * 6, polygonCount * vertexCount * 4);
+
+    int culled = 0;
+
+    for (int p = 0; p < polygonCount; ++p) {
+
+        ImU32 c = colors != nullptr ? colors[p] : col;
+        int first = p * vertexCount;
+
+        ImVec2 p0 = pixelAt(transformer, getter, first + vertexCount - 1);
+
+        for (int i = 0; i < vertexCount; ++i) {
+            ImVec2 p1 = pixelAt(transformer, getter, first + i);
+            if (cullRect.Overlaps(ImRect(ImMin(p0, p1), ImMax(p0, p1)))) {
+                PrimLineCol2(drawList, p0, p1, halfWeight, c, c, uv0, uv1);
+            } else {
+                culled++;
+            }
+            p0 = p1;
+        }
+    }
+
+    drawList.PrimUnreserve(culled * 6, culled * 4);
+}
+
+void plotPolygons(
+        const char* label,
+        const double* xs,
+        const double* ys,
+        int polygonCount,
+        int vertexCount,
+        const PlotColorInfo& lineColors,
+        const PlotColorInfo& fillColors,
+        bool fill,
+        ImPlotLineFlags flags) {
+
+    if (vertexCount < 3) {
+        throw py::value_error("Polygons need at least 3 vertices");
+    }
+
+    for (const PlotColorInfo* pci : {&lineColors, &fillColors}) {
+        if (pci->type != PlotColorType::None && pci->count != (size_t)polygonCount) {
+            std::stringstream ss;
+            ss << "color array size ("
+               << pci->count
+               << ") != number of shapes ("
+               << polygonCount
+               << ")";
+            throw py::value_error(ss.str());
+        }
+    }
+
+    int count = polygonCount * vertexCount;
+
+    using Getter = GetterXY<IndexerIdx<double>, IndexerIdx<double>>;
+    Getter getter(IndexerIdx<double>(xs, count), IndexerIdx<double>(ys, count), count);
+
+    if (BeginItemEx(label, Fitter1<Getter>(getter), flags, ImPlotCol_Line)) {
+
+        const ImPlotNextItemData& s = GetItemData();
+
+        withPixelGetter(getter, 0.0f, [&](const auto& pixelGetter) {
+
+            // colors share one buffer, so each pass resolves its own
+
+            if (fill && s.RenderFill) {
+                const ImU32* colors = fillColors.type != PlotColorType::None
+                    ? resolveColors(fillColors, 0, polygonCount)
+                    : nullptr;
+                renderPolygonFills(pixelGetter,
+                                   polygonCount,
+                                   vertexCount,
+                                   colors,
+                                   ImGui::GetColorU32(s.Colors[ImPlotCol_Fill]));
+            }
+
+            if (s.RenderLine) {
+                const ImU32* colors = lineColors.type != PlotColorType::None
+                    ? resolveColors(lineColors, 0, polygonCount)
+                    : nullptr;
+                renderPolygonOutlines(pixelGetter,
+                                      polygonCount,
+                                      vertexCount,
+                                      colors,
+                                      ImGui::GetColorU32(s.Colors[ImPlotCol_Line]),
+                                      s.LineWeight);
+            }
+        });
+
+        EndItem();
+    }
+}
+
 }
@@ -2,11 +2,62 @@
 
 namespace ImPlot {
 
+/**
+ * Plotting functions, which take the natively typed plot arrays.
+ */
+
+void plotLine(
+        const char* label,
+        PlotArrayInfo& pai,
+        ImPlotLineFlags flags = ImPlotLineFlags_None,
+        bool lod = false);
+
+void plotScatter(
+        const char* label,
+        PlotArrayInfo& pai,
+        ImPlotScatterFlags flags = ImPlotScatterFlags_None);
+
+void plotBars(
+        const char* label,
+        PlotArrayInfo& pai,
+        double barSize,
+        ImPlotBarsFlags flags = ImPlotBarsFlags_None);
+
+void plotShaded(
+        const char* label,
+        PlotArrayInfo& pai,
+        PlotBandInfo& band,
+        ImPlotShadedFlags flags = ImPlotShadedFlags_None);
+
 void customPlot(
         const char* label,
         PlotArrayInfo& pai,
-        py::handle color,
+        const PlotColorInfo& colors,
         bool noLine = false,
-        ImPlotFlags flags = ImPlotFlags_None);
+        ImPlotFlags flags = ImPlotFlags_None,
+        bool lod = false);
+
+/**
+ * Plots a batch of convex polygons as a single item.
+ *
+ * The vertices of polygon i are xs[i*vertexCount ... (i+1)*vertexCount).
+ * Colors are given per polygon, if not the item colors are used.
+ */
+void plotPolygons(
+        const char* label,
+        const double* xs,
+        const double* ys,
+        int polygonCount,
+        int vertexCount,
+        const PlotColorInfo& lineColors,
+        const PlotColorInfo& fillColors,
+        bool fill,
+        ImPlotLineFlags flags = ImPlotLineFlags_None);
+
+/**
+ * Sets the number of threads generating the vertices of large plot
+ * items. One (the default) disables the parallel path.
+ */
+void setRenderThreads(int threads);
 
 }
@@ -0,0 +1,350 @@
+#include "plot_heatmap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
+
+#include "imgui.h"
+#include "implot.h"
+#include "implot_internal.h"
+
+// a quad given by its corners in screen pixels, no vertex buffer needed
+static const char* heatmapVertexShader = R"(
+#version 330
+
+uniform vec2 pixelMin;
+uniform vec2 pixelMax;
+uniform vec2 displayPos;
+uniform vec2 displaySize;
+
+out vec2 uv;
+
+void main() {
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 p = mix(pixelMin, pixelMax, corner);
+
+    // row 0 is at the top of the plot
+    uv = corner;
+
+    vec2 n = (p - displayPos) / displaySize * 2.0 - 1.0;
+    gl_Position = vec4(n.x, -n.y, 0.0, 1.0);
+}
+)";
+
+static const char* heatmapFragmentShader = R"(
+#version 330
+
+uniform sampler2D values;
+uniform sampler2D colormap;
+uniform float scaleMin;
+uniform float scaleMax;
+uniform float colormapSize;
+
+in vec2 uv;
+
+out vec4 fragColor;
+
+void main() {
+
+    float v = texture(values, uv).r;
+
+    if (isnan(v)) {
+        discard;
+    }
+
+    float t = clamp((v - scaleMin) / (scaleMax - scaleMin), 0.0, 1.0);
+
+    // sample at texel centers, so that the ends are not blended
+    float s = (t * (colormapSize - 1.0) + 0.5) / colormapSize;
+
+    fragColor = texture(colormap, vec2(s, 0.5));
+}
+)";
+
+// resolution of the colormap lookup textures
+static constexpr int COLORMAP_TEXTURE_SIZE = 256;
+
+/**
+ * Everything the render callback needs to know about one heatmap.
+ */
+
+struct HeatmapDrawCmd {
+
+    GLuint valueTexture = 0;
+    GLuint colormapTexture = 0;
+
+    ImVec2 pixelMin;
+    ImVec2 pixelMax;
+
+    float scaleMin = 0.0f;
+    float scaleMax = 1.0f;
+};
+
+static std::deque<HeatmapDrawCmd> drawCmds;
+static int drawCmdsFrame = -1;
+
+// value range of the uploaded data, used if no scale is given
+struct HeatmapRange {
+
+    double scaleMin = 0.0;
+    double scaleMax = 1.0;
+
+    int lastFrame = -1;
+};
+
+static std::unordered_map<ImGuiID, HeatmapRange> heatmapRanges;
+
+// ranges of heatmaps not plotted for this many frames are removed
+static constexpr int HEATMAP_RANGE_FRAMES = 120;
+
+static void pruneHeatmapRanges() {
+
+    static int pruneFrame = -1;
+
+    int frame = ImGui::GetFrameCount();
+
+    if (pruneFrame == frame) {
+        return;
+    }
+
+    pruneFrame = frame;
+
+    for (auto it = heatmapRanges.begin(); it != heatmapRanges.end();) {
+        if (frame - it->second.lastFrame > HEATMAP_RANGE_FRAMES) {
+            it = heatmapRanges.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+/**
+ * Returns a 1-D lookup texture of the colormap.
+ * Colormaps cannot be changed once added, so the textures are cached.
+ */
+
+static GLuint getColormapTexture(ImPlotColormap colormap) {
+
+    static std::unordered_map<ImPlotColormap, GLuint> colormapTextures;
+
+    auto it = colormapTextures.find(colormap);
+
+    if (it != colormapTextures.end()) {
+        return it->second;
+    }
+
+    ImU32 lut[COLORMAP_TEXTURE_SIZE];
+
+    for (int i = 0; i < COLORMAP_TEXTURE_SIZE; ++i) {
+        float t = (float)i / (float)(COLORMAP_TEXTURE_SIZE - 1);
+        lut[i] = ImGui::ColorConvertFloat4ToU32(ImPlot::SampleColormap(t, colormap));
+    }
+
+    GLuint texture;
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // qualitative colormaps have hard steps
+    GLint filter = ImPlot::GetCurrentContext()->ColormapData.IsQual(colormap)
+        ? GL_NEAREST
+        : GL_LINEAR;
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+
+    glTexImage2D(GL_TEXTURE_2D,
+                 0,
+                 GL_RGBA,
+                 COLORMAP_TEXTURE_SIZE,
+                 1,
+                 0,
+                 GL_RGBA,
+                 GL_UNSIGNED_BYTE,
+                 lut);
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    colormapTextures[colormap] = texture;
+
+    return texture;
+}
+
+static void renderHeatmap(const ImDrawList*, const ImDrawCmd* cmd) {
+
+    static GLuint program = 0;
+    static GLuint vao = 0;
+
+    if (program == 0) {
+        program = compileShaderProgram(heatmapVertexShader,
+                                       nullptr,
+                                       heatmapFragmentShader);
+        // core profiles need a bound vertex array, even if it is empty
+        glGenVertexArrays(1, &vao);
+    }
+
+    HeatmapDrawCmd& dc = *(HeatmapDrawCmd*)cmd->UserCallbackData;
+
+    if (!applyCallbackScissor(cmd)) {
+        return;
+    }
+
+    ImDrawData* drawData = ImGui::GetDrawData();
+
+    glUseProgram(program);
+
+    glUniform2f(glGetUniformLocation(program, "pixelMin"), dc.pixelMin.x, dc.pixelMin.y);
+    glUniform2f(glGetUniformLocation(program, "pixelMax"), dc.pixelMax.x, dc.pixelMax.y);
+    glUniform2f(glGetUniformLocation(program, "displayPos"),
+                drawData->DisplayPos.x,
+                drawData->DisplayPos.y);
+    glUniform2f(glGetUniformLocation(program, "displaySize"),
+                drawData->DisplaySize.x,
+                drawData->DisplaySize.y);
+    glUniform1f(glGetUniformLocation(program, "scaleMin"), dc.scaleMin);
+    glUniform1f(glGetUniformLocation(program, "scaleMax"), dc.scaleMax);
+    glUniform1f(glGetUniformLocation(program, "colormapSize"), (float)COLORMAP_TEXTURE_SIZE);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, dc.colormapTexture);
+    glUniform1i(glGetUniformLocation(program, "colormap"), 1);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, dc.valueTexture);
+    glUniform1i(glGetUniformLocation(program, "values"), 0);
+
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+}
+
+static void findValueRange(py::array& values, double& scaleMin, double& scaleMax) {
+
+    array_like<float> arr = array_like<float>::ensure(values);
+
+    const float* data = arr.data();
+    size_t count = arr.size();
+
+    float lo = HUGE_VALF;
+    float hi = -HUGE_VALF;
+
+    // v == v is not reliable with -ffast-math, so test the exponent bits
+    for (size_t i = 0; i < count; ++i) {
+        float v = data[i];
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof(bits));
+        if ((bits & 0x7f800000u) == 0x7f800000u) {
+            continue;
+        }
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+
+    if (lo > hi) {
+        lo = 0.0f;
+        hi = 1.0f;
+    } else if (lo == hi) {
+        hi = lo + 1.0f;
+    }
+
+    scaleMin = lo;
+    scaleMax = hi;
+}
+
+void plotHeatmap(const char* label,
+                 py::array& values,
+                 ImPlotPoint boundsMin,
+                 ImPlotPoint boundsMax,
+                 ImPlotColormap colormap,
+                 double scaleMin,
+                 double scaleMax,
+                 bool interpolate,
+                 bool skipUpload,
+                 ImPlotItemFlags flags) {
+
+    assert_shape(values, {{-1, -1}});
+
+    // upload as a single channel float texture, which keeps the values
+    // unnormalized, so the scale can change without uploading again
+
+    ImageInfo info;
+    info.imageWidth = values.shape(1);
+    info.imageHeight = values.shape(0);
+    info.channels = 1;
+    info.format = GL_RED;
+    info.datatype = GL_FLOAT;
+    info.internalFormat = GL_R32F;
+
+    bool uploaded = false;
+
+    GLuint valueTexture = uploadImage(label, info, values, skipUpload, interpolate,
+                                      nullptr, false, ImVec2(0.0f, 0.0f), &uploaded);
+
+    // the data only has to be scanned if it changed, uploadImage has
+    // converted it to float already in that case
+
+    if (scaleMin == scaleMax) {
+
+        pruneHeatmapRanges();
+
+        auto it = heatmapRanges.find(ImGui::GetID(label));
+
+        if (it == heatmapRanges.end()) {
+            it = heatmapRanges.emplace(ImGui::GetID(label), HeatmapRange()).first;
+            uploaded = true;
+        }
+
+        HeatmapRange& range = it->second;
+
+        if (uploaded) {
+            findValueRange(values, range.scaleMin, range.scaleMax);
+        }
+
+        range.lastFrame = ImGui::GetFrameCount();
+
+        scaleMin = range.scaleMin;
+        scaleMax = range.scaleMax;
+    }
+
+    if (ImPlot::BeginItem(label, flags, ImPlotCol_Fill)) {
+
+        if (ImPlot::FitThisFrame()) {
+            ImPlot::FitPoint(boundsMin);
+            ImPlot::FitPoint(boundsMax);
+        }
+
+        // commands of the previous frame have been rendered already
+
+        if (drawCmdsFrame != ImGui::GetFrameCount()) {
+            drawCmds.clear();
+            drawCmdsFrame = ImGui::GetFrameCount();
+        }
+
+        if (colormap == IMPLOT_AUTO) {
+            colormap = ImPlot::GetStyle().Colormap;
+        }
+
+        HeatmapDrawCmd& dc = drawCmds.emplace_back();
+
+        dc.valueTexture = valueTexture;
+        dc.colormapTexture = getColormapTexture(colormap);
+        dc.scaleMin = (float)scaleMin;
+        dc.scaleMax = (float)scaleMax;
+
+        // row 0 is at the top, i.e. at the maximum of the y bounds
+        dc.pixelMin = ImPlot::PlotToPixels(boundsMin.x, boundsMax.y);
+        dc.pixelMax = ImPlot::PlotToPixels(boundsMax.x, boundsMin.y);
+
+        ImDrawList& drawList = *ImPlot::GetPlotDrawList();
+        drawList.AddCallback(renderHeatmap, &dc);
+        drawList.AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+
+        ImPlot::EndItem();
+    }
+}
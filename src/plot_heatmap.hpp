@@ -0,0 +1,28 @@
+#pragma once
+
+#include "binding_helpers.hpp"
+
+/**
+ * Plots a 2-D array of scalars as a heatmap.
+ *
+ * The values are stored in a float texture, which is only uploaded if
+ * the data changed and skipUpload is not set, and the colormap is
+ * applied in a fragment shader. The cost of drawing is therefore
+ * independent of the number of cells. Row 0 is drawn at the top, like
+ * ImPlot::PlotHeatmap does.
+ *
+ * If scaleMin == scaleMax, the value range of the data is used. It is
+ * only computed again when the texture is uploaded.
+ * NaN values are transparent.
+ */
+
+void plotHeatmap(const char* label,
+                 py::array& values,
+                 ImPlotPoint boundsMin,
+                 ImPlotPoint boundsMax,
+                 ImPlotColormap colormap = IMPLOT_AUTO,
+                 double scaleMin = 0.0,
+                 double scaleMax = 0.0,
+                 bool interpolate = false,
+                 bool skipUpload = false,
+                 ImPlotItemFlags flags = ImPlotItemFlags_None);
@@ -0,0 +1,531 @@
+#include "plot_histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "imgui.h"
+#include "implot.h"
+#include "implot_internal.h"
+
+#include "plot_heatmap.hpp"
+#include "thread_pool.hpp"
+
+// number of values converted to bin indices at once
+static constexpr size_t BIN_BLOCK = 4096;
+
+// smaller inputs are binned by the calling thread only
+static constexpr size_t PARALLEL_MIN_VALUES = 1 << 16;
+
+/**
+ * Maps values to bins, the maximum of the range belongs to the last bin.
+ */
+
+struct BinAxis {
+
+    double min = 0.0;
+    double max = 1.0;
+    double scale = 1.0;
+    int bins = 1;
+
+    double width() const { return (max - min) / bins; }
+};
+
+struct AxisStats {
+
+    double min = HUGE_VAL;
+    double max = -HUGE_VAL;
+    double sum = 0.0;
+    double sumSq = 0.0;
+    size_t count = 0;
+
+    void merge(const AxisStats& o) {
+        min = std::min(min, o.min);
+        max = std::max(max, o.max);
+        sum += o.sum;
+        sumSq += o.sumSq;
+        count += o.count;
+    }
+};
+
+/**
+ * The bin counts of one plot item and what they were computed from.
+ */
+
+struct HistogramCache {
+
+    // references keep the buffers alive, so that their memory cannot be
+    // reused by other arrays while the pointers are compared
+    py::array xArray;
+    py::array yArray;
+
+    const void* xPtr = nullptr;
+    const void* yPtr = nullptr;
+    ptrdiff_t xStride = 0;
+    ptrdiff_t yStride = 0;
+    size_t count = 0;
+    PlotDataType dataType = PlotDataType::Unknown;
+
+    int xBinsArg = 0;
+    int yBinsArg = 0;
+    ImPlotRect rangeArg;
+
+    BinAxis xAxis;
+    BinAxis yAxis;
+
+    std::vector<double> counts;
+    double total = 0.0;
+
+    // density texture of 2-D histograms and whether it has been uploaded
+    std::vector<float> image;
+    bool imageDensity = false;
+    bool uploaded = false;
+
+    int lastFrame = -1;
+};
+
+static std::unordered_map<ImGuiID, HistogramCache> histogramCache;
+
+// histograms not plotted for this many frames are removed from the cache
+static constexpr int HISTOGRAM_CACHE_FRAMES = 120;
+
+/**
+ * Removes unused histograms once per frame, which also releases the
+ * references to their data.
+ */
+
+static void pruneHistograms() {
+
+    static int pruneFrame = -1;
+
+    int frame = ImGui::GetFrameCount();
+
+    if (pruneFrame == frame) {
+        return;
+    }
+
+    pruneFrame = frame;
+
+    for (auto it = histogramCache.begin(); it != histogramCache.end();) {
+        if (frame - it->second.lastFrame > HISTOGRAM_CACHE_FRAMES) {
+            it = histogramCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+template <typename T>
+static inline T readValue(const void* ptr, ptrdiff_t stride, size_t idx) {
+
+    return *(const T*)((const uint8_t*)ptr + stride * (ptrdiff_t)idx);
+}
+
+static inline int binIndex(double v, const BinAxis& axis) {
+
+    double t = (v - axis.min) * axis.scale;
+
+    if (t < 0.0 || t > axis.bins) {
+        return -1;
+    }
+
+    return std::min((int)t, axis.bins - 1);
+}
+
+/**
+ * Splits [0, count) into contiguous parts and calls func(part, begin, end)
+ * for each of them on the thread pool. Returns the number of parts.
+ */
+
+template <typename F>
+static int forEachPart(size_t count, F&& func) {
+
+    ThreadPool& pool = getThreadPool();
+
+    int parts = 1;
+    if (count >= PARALLEL_MIN_VALUES) {
+        parts = (int)std::min(pool.size() + 1, count / (PARALLEL_MIN_VALUES / 4));
+    }
+
+    size_t partSize = (count + parts - 1) / parts;
+
+    pool.parallelFor(parts, [&](int part) {
+        size_t begin = std::min(count, part * partSize);
+        size_t end = std::min(count, begin + partSize);
+        func(part, begin, end);
+    });
+
+    return parts;
+}
+
+template <typename T>
+static AxisStats computeStats(const void* ptr, ptrdiff_t stride, size_t count) {
+
+    ThreadPool& pool = getThreadPool();
+    std::vector<AxisStats> partStats(pool.size() + 1);
+
+    int parts = forEachPart(count, [&](int part, size_t begin, size_t end) {
+        AxisStats s;
+        for (size_t i = begin; i < end; ++i) {
+            T v = readValue<T>(ptr, stride, i);
+            if (!isFiniteValue(v)) {
+                continue;
+            }
+            double d = (double)v;
+            s.min = std::min(s.min, d);
+            s.max = std::max(s.max, d);
+            s.sum += d;
+            s.sumSq += d * d;
+            s.count++;
+        }
+        partStats[part] = s;
+    });
+
+    AxisStats stats;
+    for (int i = 0; i < parts; ++i) {
+        stats.merge(partStats[i]);
+    }
+
+    return stats;
+}
+
+/**
+ * Like ImPlot's CalculateBins, but on the precomputed statistics.
+ */
+
+static BinAxis makeBinAxis(int binsArg, ImPlotRange range, const AxisStats& stats) {
+
+    BinAxis axis;
+
+    if (range.Min < range.Max) {
+        axis.min = range.Min;
+        axis.max = range.Max;
+    } else if (stats.count > 0) {
+        axis.min = stats.min;
+        axis.max = stats.max;
+    }
+
+    if (axis.max <= axis.min) {
+        axis.min -= 0.5;
+        axis.max += 0.5;
+    }
+
+    double n = (double)std::max<size_t>(stats.count, 1);
+    double span = axis.max - axis.min;
+
+    int bins = binsArg;
+
+    switch (binsArg) {
+        case ImPlotBin_Sqrt:
+            bins = (int)std::ceil(std::sqrt(n));
+            break;
+        case ImPlotBin_Sturges:
+            bins = (int)std::ceil(1.0 + std::log2(n));
+            break;
+        case ImPlotBin_Rice:
+            bins = (int)std::ceil(2.0 * std::cbrt(n));
+            break;
+        case ImPlotBin_Scott: {
+            double mean = stats.sum / n;
+            double var = std::max(0.0, stats.sumSq / n - mean * mean);
+            double width = 3.49 * std::sqrt(var) / std::cbrt(n);
+            bins = width > 0.0 ? (int)std::round(span / width) : 1;
+            break;
+        }
+        default:
+            break;
+    }
+
+    axis.bins = std::max(1, bins);
+    axis.scale = axis.bins / span;
+
+    return axis;
+}
+
+/**
+ * Counts the values of [begin, end) into counts.
+ *
+ * The values are processed in blocks, which are first converted to bin
+ * indices and then counted. The conversion loop is free of scattered
+ * writes and the block of indices stays in the L1 cache.
+ */
+
+template <typename T>
+static void countBins(const PlotArrayInfo& pai,
+                      bool twoD,
+                      const BinAxis& xAxis,
+                      const BinAxis& yAxis,
+                      size_t begin,
+                      size_t end,
+                      uint32_t* counts) {
+
+    int indices[BIN_BLOCK];
+
+    for (size_t block = begin; block < end; block += BIN_BLOCK) {
+
+        size_t n = std::min(BIN_BLOCK, end - block);
+
+        if (twoD) {
+            for (size_t k = 0; k < n; ++k) {
+                T x = readValue<T>(pai.xDataPtr, pai.xStride, block + k);
+                T y = readValue<T>(pai.yDataPtr, pai.yStride, block + k);
+                int ix = isFiniteValue(x) ? binIndex((double)x, xAxis) : -1;
+                int iy = isFiniteValue(y) ? binIndex((double)y, yAxis) : -1;
+                indices[k] = (ix < 0 || iy < 0) ? -1 : iy * xAxis.bins + ix;
+            }
+        } else {
+            for (size_t k = 0; k < n; ++k) {
+                T y = readValue<T>(pai.yDataPtr, pai.yStride, block + k);
+                indices[k] = isFiniteValue(y) ? binIndex((double)y, yAxis) : -1;
+            }
+        }
+
+        for (size_t k = 0; k < n; ++k) {
+            if (indices[k] >= 0) {
+                counts[indices[k]]++;
+            }
+        }
+    }
+}
+
+/**
+ * Bins the data in parallel, each part counts into its own histogram.
+ */
+
+template <typename T>
+static void computeHistogram(const PlotArrayInfo& pai,
+                             bool twoD,
+                             HistogramCache& hc) {
+
+    size_t binCount = (size_t)hc.xAxis.bins * hc.yAxis.bins;
+
+    ThreadPool& pool = getThreadPool();
+    std::vector<std::vector<uint32_t>> partCounts(pool.size() + 1);
+
+    int parts = forEachPart(pai.count, [&](int part, size_t begin, size_t end) {
+        std::vector<uint32_t>& counts = partCounts[part];
+        counts.assign(binCount, 0);
+        countBins<T>(pai, twoD, hc.xAxis, hc.yAxis, begin, end, counts.data());
+    });
+
+    hc.counts.assign(binCount, 0.0);
+    hc.total = 0.0;
+
+    for (int p = 0; p < parts; ++p) {
+        for (size_t b = 0; b < binCount; ++b) {
+            hc.counts[b] += partCounts[p][b];
+        }
+    }
+
+    for (double c : hc.counts) {
+        hc.total += c;
+    }
+}
+
+/**
+ * Returns the cached histogram of the data, which is computed again
+ * if the data or the binning parameters have changed.
+ */
+
+static HistogramCache& getHistogram(const char* label,
+                                    const PlotArrayInfo& pai,
+                                    bool twoD,
+                                    int xBins,
+                                    int yBins,
+                                    ImPlotRect range,
+                                    bool cache) {
+
+    pruneHistograms();
+
+    HistogramCache& hc = histogramCache[ImGui::GetID(label)];
+    hc.lastFrame = ImGui::GetFrameCount();
+
+    bool valid = cache
+        && hc.xPtr == pai.xDataPtr
+        && hc.yPtr == pai.yDataPtr
+        && hc.xStride == pai.xStride
+        && hc.yStride == pai.yStride
+        && hc.count == pai.count
+        && hc.dataType == pai.dataType
+        && hc.xBinsArg == xBins
+        && hc.yBinsArg == yBins
+        && hc.rangeArg.X.Min == range.X.Min
+        && hc.rangeArg.X.Max == range.X.Max
+        && hc.rangeArg.Y.Min == range.Y.Min
+        && hc.rangeArg.Y.Max == range.Y.Max
+        && !hc.counts.empty();
+
+    if (valid) {
+        return hc;
+    }
+
+    hc.xArray = pai.xArray;
+    hc.yArray = pai.yArray;
+    hc.xPtr = pai.xDataPtr;
+    hc.yPtr = pai.yDataPtr;
+    hc.xStride = pai.xStride;
+    hc.yStride = pai.yStride;
+    hc.count = pai.count;
+    hc.dataType = pai.dataType;
+    hc.xBinsArg = xBins;
+    hc.yBinsArg = yBins;
+    hc.rangeArg = range;
+    hc.uploaded = false;
+
+    dispatchDataType(pai.dataType, [&](auto tag) {
+
+        using T = decltype(tag);
+
+        // 1-D histograms bin the values of y, x is implicit
+
+        AxisStats yStats = computeStats<T>(pai.yDataPtr, pai.yStride, pai.count);
+        hc.yAxis = makeBinAxis(yBins, range.Y, yStats);
+
+        if (twoD) {
+            AxisStats xStats = computeStats<T>(pai.xDataPtr, pai.xStride, pai.count);
+            hc.xAxis = makeBinAxis(xBins, range.X, xStats);
+        } else {
+            hc.xAxis = BinAxis();
+        }
+
+        computeHistogram<T>(pai, twoD, hc);
+    });
+
+    return hc;
+}
+
+void plotHistogram(const char* label,
+                   py::array& values,
+                   int bins,
+                   ImPlotRange range,
+                   bool density,
+                   bool cumulative,
+                   bool horizontal,
+                   double barScale,
+                   bool cache) {
+
+    py::array none;
+    PlotArrayInfo pai = interpretPlotArrays(values, none);
+
+    if (!pai.implicitX) {
+        throw py::value_error("Expected a 1-D array of values, got shape " + shapeToStr(values));
+    }
+
+    ImPlotRect rangeRect(0.0, 0.0, range.Min, range.Max);
+
+    HistogramCache& hc = getHistogram(label, pai, false, 0, bins, rangeRect, cache);
+
+    const BinAxis& axis = hc.yAxis;
+    double width = axis.width();
+
+    std::vector<double> centers(axis.bins);
+    std::vector<double> heights(hc.counts);
+
+    for (int i = 0; i < axis.bins; ++i) {
+        centers[i] = axis.min + width * (i + 0.5);
+    }
+
+    if (cumulative) {
+        for (int i = 1; i < axis.bins; ++i) {
+            heights[i] += heights[i - 1];
+        }
+    }
+
+    if (density && hc.total > 0.0) {
+        // cumulative densities end at one
+        double norm = cumulative ? 1.0 / hc.total : 1.0 / (hc.total * width);
+        for (double& h : heights) {
+            h *= norm;
+        }
+    }
+
+    if (horizontal) {
+        ImPlot::PlotBars(label,
+                         heights.data(),
+                         centers.data(),
+                         axis.bins,
+                         width * barScale,
+                         ImPlotBarsFlags_Horizontal);
+    } else {
+        ImPlot::PlotBars(label,
+                         centers.data(),
+                         heights.data(),
+                         axis.bins,
+                         width * barScale);
+    }
+}
+
+void plotHistogram2d(const char* label,
+                     py::array& x,
+                     py::array& y,
+                     int xBins,
+                     int yBins,
+                     ImPlotRect range,
+                     bool density,
+                     ImPlotColormap colormap,
+                     bool cache,
+                     ImPlotItemFlags flags) {
+
+    PlotArrayInfo pai = interpretPlotArrays(x, y);
+
+    if (pai.implicitX) {
+        throw py::value_error("Expected x and y values");
+    }
+
+    HistogramCache& hc = getHistogram(label, pai, true, xBins, yBins, range, cache);
+
+    const BinAxis& ax = hc.xAxis;
+    const BinAxis& ay = hc.yAxis;
+
+    double norm = 1.0;
+    if (density && hc.total > 0.0) {
+        norm = 1.0 / (hc.total * ax.width() * ay.width());
+    }
+
+    if (hc.imageDensity != density) {
+        hc.imageDensity = density;
+        hc.uploaded = false;
+    }
+
+    // the heatmap draws row 0 at the top, i.e. at the largest y
+
+    if (!hc.uploaded) {
+        hc.image.resize(hc.counts.size());
+        for (int iy = 0; iy < ay.bins; ++iy) {
+            const double* src = hc.counts.data() + (size_t)iy * ax.bins;
+            float* dst = hc.image.data() + (size_t)(ay.bins - 1 - iy) * ax.bins;
+            for (int ix = 0; ix < ax.bins; ++ix) {
+                dst[ix] = (float)(src[ix] * norm);
+            }
+        }
+    }
+
+    double maxValue = 0.0;
+    for (double c : hc.counts) {
+        maxValue = std::max(maxValue, c * norm);
+    }
+    if (maxValue <= 0.0) {
+        maxValue = 1.0;
+    }
+
+    // a view of the cached image, it is only read if not uploaded yet
+
+    py::array_t<float> image({(py::ssize_t)ay.bins, (py::ssize_t)ax.bins},
+                             hc.image.data(),
+                             py::none());
+
+    plotHeatmap(label,
+                image,
+                ImPlotPoint(ax.min, ay.min),
+                ImPlotPoint(ax.max, ay.max),
+                colormap,
+                0.0,
+                maxValue,
+                false,
+                hc.uploaded,
+                flags);
+
+    hc.uploaded = true;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "binding_helpers.hpp"
+
+/**
+ * Histograms, which are binned natively on the thread pool of the plot
+ * renderers (see setRenderThreads).
+ *
+ * Bins are either given as a count or as one of the ImPlotBin methods.
+ * If the range is empty, the range of the finite values is used.
+ *
+ * The bin counts are cached per label and only computed again if the
+ * data buffer, its layout or the binning parameters change. Arrays
+ * which are modified in place must therefore be plotted with cache set
+ * to false. Histograms, which have not been plotted for a while, are
+ * removed from the cache.
+ */
+
+void plotHistogram(const char* label,
+                   py::array& values,
+                   int bins = ImPlotBin_Sturges,
+                   ImPlotRange range = ImPlotRange(),
+                   bool density = false,
+                   bool cumulative = false,
+                   bool horizontal = false,
+                   double barScale = 1.0,
+                   bool cache = true);
+
+/**
+ * 2-D histogram, which is displayed as a density texture.
+ */
+
+void plotHistogram2d(const char* label,
+                     py::array& x,
+                     py::array& y,
+                     int xBins = ImPlotBin_Sturges,
+                     int yBins = ImPlotBin_Sturges,
+                     ImPlotRect range = ImPlotRect(),
+                     bool density = false,
+                     ImPlotColormap colormap = IMPLOT_AUTO,
+                     bool cache = true,
+                     ImPlotItemFlags flags = ImPlotItemFlags_None);
@@ -0,0 +1,306 @@
+#include "plot_kernels.hpp"
+
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PLOT_KERNELS_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// msvc allows intrinsics of any instruction set without target flags
+#if defined(__GNUC__) || defined(__clang__)
+#define KERNEL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define KERNEL_TARGET(isa)
+#endif
+
+/**
+ * Scalar versions, which also process the remainders of the simd loops.
+ */
+
+static void transformLinearScalar(const double* xs,
+                                  const double* ys,
+                                  size_t count,
+                                  const LinearAxisMap& xMap,
+                                  const LinearAxisMap& yMap,
+                                  float* px,
+                                  float* py) {
+
+    for (size_t i = 0; i < count; ++i) {
+        px[i] = (float)(xMap.pixMin + xMap.scale * (xs[i] - xMap.pltMin));
+        py[i] = (float)(yMap.pixMin + yMap.scale * (ys[i] - yMap.pltMin));
+    }
+}
+
+static void computeLineOffsetsScalar(const float* px,
+                                     const float* py,
+                                     size_t segments,
+                                     float halfWeight,
+                                     float* ox,
+                                     float* oy) {
+
+    for (size_t i = 0; i < segments; ++i) {
+
+        float dx = px[i + 1] - px[i];
+        float dy = py[i + 1] - py[i];
+        float d2 = dx * dx + dy * dy;
+
+        float s = d2 > 0.0f ? halfWeight / std::sqrt(d2) : 0.0f;
+
+        ox[i] = dy * s;
+        oy[i] = -dx * s;
+    }
+}
+
+#ifdef PLOT_KERNELS_X86
+
+static void transformLinearSse2(const double* xs,
+                                const double* ys,
+                                size_t count,
+                                const LinearAxisMap& xMap,
+                                const LinearAxisMap& yMap,
+                                float* px,
+                                float* py) {
+
+    const __m128d xPlt = _mm_set1_pd(xMap.pltMin);
+    const __m128d xPix = _mm_set1_pd(xMap.pixMin);
+    const __m128d xScale = _mm_set1_pd(xMap.scale);
+    const __m128d yPlt = _mm_set1_pd(yMap.pltMin);
+    const __m128d yPix = _mm_set1_pd(yMap.pixMin);
+    const __m128d yScale = _mm_set1_pd(yMap.scale);
+
+    size_t i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+
+        __m128d x0 = _mm_loadu_pd(xs + i);
+        __m128d x1 = _mm_loadu_pd(xs + i + 2);
+        __m128d y0 = _mm_loadu_pd(ys + i);
+        __m128d y1 = _mm_loadu_pd(ys + i + 2);
+
+        x0 = _mm_add_pd(xPix, _mm_mul_pd(xScale, _mm_sub_pd(x0, xPlt)));
+        x1 = _mm_add_pd(xPix, _mm_mul_pd(xScale, _mm_sub_pd(x1, xPlt)));
+        y0 = _mm_add_pd(yPix, _mm_mul_pd(yScale, _mm_sub_pd(y0, yPlt)));
+        y1 = _mm_add_pd(yPix, _mm_mul_pd(yScale, _mm_sub_pd(y1, yPlt)));
+
+        _mm_storeu_ps(px + i, _mm_movelh_ps(_mm_cvtpd_ps(x0), _mm_cvtpd_ps(x1)));
+        _mm_storeu_ps(py + i, _mm_movelh_ps(_mm_cvtpd_ps(y0), _mm_cvtpd_ps(y1)));
+    }
+
+    transformLinearScalar(xs + i, ys + i, count - i, xMap, yMap, px + i, py + i);
+}
+
+static void computeLineOffsetsSse2(const float* px,
+                                   const float* py,
+                                   size_t segments,
+                                   float halfWeight,
+                                   float* ox,
+                                   float* oy) {
+
+    const __m128 half = _mm_set1_ps(halfWeight);
+    const __m128 zero = _mm_setzero_ps();
+
+    size_t i = 0;
+
+    for (; i + 4 <= segments; i += 4) {
+
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(px + i + 1), _mm_loadu_ps(px + i));
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(py + i + 1), _mm_loadu_ps(py + i));
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+        // zero length segments get no offset, like in implot
+        __m128 s = _mm_and_ps(_mm_rsqrt_ps(d2), _mm_cmpgt_ps(d2, zero));
+        s = _mm_mul_ps(s, half);
+
+        _mm_storeu_ps(ox + i, _mm_mul_ps(dy, s));
+        _mm_storeu_ps(oy + i, _mm_sub_ps(zero, _mm_mul_ps(dx, s)));
+    }
+
+    computeLineOffsetsScalar(px + i, py + i, segments - i, halfWeight, ox + i, oy + i);
+}
+
+KERNEL_TARGET("avx2")
+static void transformLinearAvx2(const double* xs,
+                                const double* ys,
+                                size_t count,
+                                const LinearAxisMap& xMap,
+                                const LinearAxisMap& yMap,
+                                float* px,
+                                float* py) {
+
+    const __m256d xPlt = _mm256_set1_pd(xMap.pltMin);
+    const __m256d xPix = _mm256_set1_pd(xMap.pixMin);
+    const __m256d xScale = _mm256_set1_pd(xMap.scale);
+    const __m256d yPlt = _mm256_set1_pd(yMap.pltMin);
+    const __m256d yPix = _mm256_set1_pd(yMap.pixMin);
+    const __m256d yScale = _mm256_set1_pd(yMap.scale);
+
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+
+        __m256d x0 = _mm256_loadu_pd(xs + i);
+        __m256d x1 = _mm256_loadu_pd(xs + i + 4);
+        __m256d y0 = _mm256_loadu_pd(ys + i);
+        __m256d y1 = _mm256_loadu_pd(ys + i + 4);
+
+        x0 = _mm256_add_pd(xPix, _mm256_mul_pd(xScale, _mm256_sub_pd(x0, xPlt)));
+        x1 = _mm256_add_pd(xPix, _mm256_mul_pd(xScale, _mm256_sub_pd(x1, xPlt)));
+        y0 = _mm256_add_pd(yPix, _mm256_mul_pd(yScale, _mm256_sub_pd(y0, yPlt)));
+        y1 = _mm256_add_pd(yPix, _mm256_mul_pd(yScale, _mm256_sub_pd(y1, yPlt)));
+
+        _mm256_storeu_ps(px + i, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(x0)), _mm256_cvtpd_ps(x1), 1));
+        _mm256_storeu_ps(py + i, _mm256_insertf128_ps(_mm256_castps128_ps256(_mm256_cvtpd_ps(y0)), _mm256_cvtpd_ps(y1), 1));
+    }
+
+    transformLinearSse2(xs + i, ys + i, count - i, xMap, yMap, px + i, py + i);
+}
+
+KERNEL_TARGET("avx2")
+static void computeLineOffsetsAvx2(const float* px,
+                                   const float* py,
+                                   size_t segments,
+                                   float halfWeight,
+                                   float* ox,
+                                   float* oy) {
+
+    const __m256 half = _mm256_set1_ps(halfWeight);
+    const __m256 zero = _mm256_setzero_ps();
+
+    size_t i = 0;
+
+    for (; i + 8 <= segments; i += 8) {
+
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(px + i + 1), _mm256_loadu_ps(px + i));
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(py + i + 1), _mm256_loadu_ps(py + i));
+        __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+        __m256 s = _mm256_and_ps(_mm256_rsqrt_ps(d2), _mm256_cmp_ps(d2, zero, _CMP_GT_OQ));
+        s = _mm256_mul_ps(s, half);
+
+        _mm256_storeu_ps(ox + i, _mm256_mul_ps(dy, s));
+        _mm256_storeu_ps(oy + i, _mm256_sub_ps(zero, _mm256_mul_ps(dx, s)));
+    }
+
+    computeLineOffsetsSse2(px + i, py + i, segments - i, halfWeight, ox + i, oy + i);
+}
+
+static bool cpuHasAvx2() {
+
+#ifdef _MSC_VER
+    int info[4];
+
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+
+    // the os must save the ymm registers on context switches
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+/**
+ * Runtime dispatch.
+ */
+
+enum class KernelIsa {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+static KernelIsa detectIsa() {
+
+#ifdef PLOT_KERNELS_X86
+    // sse2 is part of the x86-64 baseline
+    return cpuHasAvx2() ? KernelIsa::Avx2 : KernelIsa::Sse2;
+#else
+    return KernelIsa::Scalar;
+#endif
+}
+
+static KernelIsa getIsa() {
+
+    static const KernelIsa isa = detectIsa();
+
+    return isa;
+}
+
+void transformLinear(const double* xs,
+                     const double* ys,
+                     size_t count,
+                     const LinearAxisMap& xMap,
+                     const LinearAxisMap& yMap,
+                     float* px,
+                     float* py) {
+
+    switch (getIsa()) {
+#ifdef PLOT_KERNELS_X86
+        case KernelIsa::Avx2:
+            transformLinearAvx2(xs, ys, count, xMap, yMap, px, py);
+            break;
+        case KernelIsa::Sse2:
+            transformLinearSse2(xs, ys, count, xMap, yMap, px, py);
+            break;
+#endif
+        default:
+            transformLinearScalar(xs, ys, count, xMap, yMap, px, py);
+            break;
+    }
+}
+
+void computeLineOffsets(const float* px,
+                        const float* py,
+                        size_t count,
+                        float halfWeight,
+                        float* ox,
+                        float* oy) {
+
+    if (count < 2) {
+        return;
+    }
+
+    size_t segments = count - 1;
+
+    switch (getIsa()) {
+#ifdef PLOT_KERNELS_X86
+        case KernelIsa::Avx2:
+            computeLineOffsetsAvx2(px, py, segments, halfWeight, ox, oy);
+            break;
+        case KernelIsa::Sse2:
+            computeLineOffsetsSse2(px, py, segments, halfWeight, ox, oy);
+            break;
+#endif
+        default:
+            computeLineOffsetsScalar(px, py, segments, halfWeight, ox, oy);
+            break;
+    }
+}
+
+const char* getKernelIsa() {
+
+    switch (getIsa()) {
+        case KernelIsa::Avx2:
+            return "avx2";
+        case KernelIsa::Sse2:
+            return "sse2";
+        default:
+            return "scalar";
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Vectorized inner loops of the plot renderers.
+ *
+ * The kernels are compiled for several instruction sets and the best
+ * one supported by the cpu is selected at runtime, so the module does
+ * not depend on the flags it was built with.
+ */
+
+/**
+ * Maps plot values of a linear axis to pixels, like the implot
+ * transformer does: pixMin + scale * (v - pltMin).
+ */
+struct LinearAxisMap {
+
+    double pltMin = 0.0;
+    double pixMin = 0.0;
+    double scale = 1.0;
+};
+
+/**
+ * Transforms count points to pixel coordinates.
+ */
+void transformLinear(const double* xs,
+                     const double* ys,
+                     size_t count,
+                     const LinearAxisMap& xMap,
+                     const LinearAxisMap& yMap,
+                     float* px,
+                     float* py);
+
+/**
+ * Computes the offsets of the quad corners of the count - 1 segments of
+ * a line strip, which is the segment normal scaled by halfWeight.
+ * Degenerate segments get a zero offset.
+ */
+void computeLineOffsets(const float* px,
+                        const float* py,
+                        size_t count,
+                        float halfWeight,
+                        float* ox,
+                        float* oy);
+
+/**
+ * Name of the selected instruction set ("avx2", "sse2" or "scalar").
+ */
+const char* getKernelIsa();
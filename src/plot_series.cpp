@@ -0,0 +1,381 @@
+#include "plot_series.hpp"
+
+#include <cmath>
+#include <deque>
+#include <vector>
+
+#include "imgui.h"
+#include "implot.h"
+#include "implot_internal.h"
+
+static const char* seriesVertexShader = R"(
+#version 330
+
+layout (location = 0) in vec2 position;
+
+// 0 = linear, 1 = log10, 2 = symlog
+uniform ivec2 axisMode;
+
+uniform vec2 offset;
+uniform vec2 linearScale;
+uniform vec2 linearShift;
+
+uniform vec2 scaleMin;
+uniform vec2 scaleMax;
+uniform vec2 pixelMin;
+uniform vec2 pixelSpan;
+
+float toPixel(int axis, float v) {
+
+    if (axisMode[axis] == 0) {
+        return linearScale[axis] * v + linearShift[axis];
+    }
+
+    float plt = v + offset[axis];
+    float s = 0.0;
+
+    if (axisMode[axis] == 1) {
+        s = log(max(plt, 1e-37)) / log(10.0);
+    } else {
+        s = 2.0 * asinh(plt / 2.0);
+    }
+
+    float t = (s - scaleMin[axis]) / (scaleMax[axis] - scaleMin[axis]);
+
+    return pixelMin[axis] + pixelSpan[axis] * t;
+}
+
+void main() {
+    gl_Position = vec4(toPixel(0, position.x), toPixel(1, position.y), 0.0, 1.0);
+}
+)";
+
+// expands each line segment into a quad of the given pixel width
+static const char* seriesGeometryShader = R"(
+#version 330
+
+layout (lines) in;
+layout (triangle_strip, max_vertices = 4) out;
+
+uniform vec2 displayPos;
+uniform vec2 displaySize;
+uniform float weight;
+
+vec4 toNdc(vec2 p) {
+    vec2 n = (p - displayPos) / displaySize * 2.0 - 1.0;
+    return vec4(n.x, -n.y, 0.0, 1.0);
+}
+
+void main() {
+
+    vec2 a = gl_in[0].gl_Position.xy;
+    vec2 b = gl_in[1].gl_Position.xy;
+
+    vec2 d = b - a;
+    float len = length(d);
+
+    vec2 n = vec2(0.0);
+    if (len > 0.0) {
+        n = vec2(-d.y, d.x) / len * (0.5 * weight);
+    }
+
+    gl_Position = toNdc(a + n);
+    EmitVertex();
+    gl_Position = toNdc(a - n);
+    EmitVertex();
+    gl_Position = toNdc(b + n);
+    EmitVertex();
+    gl_Position = toNdc(b - n);
+    EmitVertex();
+
+    EndPrimitive();
+}
+)";
+
+static const char* seriesFragmentShader = R"(
+#version 330
+
+uniform vec4 color;
+
+out vec4 fragColor;
+
+void main() {
+    fragColor = color;
+}
+)";
+
+/**
+ * Everything the render callback needs to know about one drawn series.
+ */
+
+struct PlotSeriesDrawCmd {
+
+    std::shared_ptr<PlotSeriesBuffer> buffer;
+    int count = 0;
+
+    GLint axisMode[2] = {0, 0};
+
+    float offset[2] = {0.0f, 0.0f};
+    float linearScale[2] = {0.0f, 0.0f};
+    float linearShift[2] = {0.0f, 0.0f};
+
+    float scaleMin[2] = {0.0f, 0.0f};
+    float scaleMax[2] = {0.0f, 0.0f};
+    float pixelMin[2] = {0.0f, 0.0f};
+    float pixelSpan[2] = {0.0f, 0.0f};
+
+    ImVec4 color;
+    float weight = 1.0f;
+};
+
+// a deque keeps the commands in place while new ones are added
+static std::deque<PlotSeriesDrawCmd> drawCmds;
+static int drawCmdsFrame = -1;
+
+PlotSeriesBuffer::PlotSeriesBuffer() {
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+PlotSeriesBuffer::~PlotSeriesBuffer() {
+
+    glDeleteBuffers(1, &vbo);
+    glDeleteVertexArrays(1, &vao);
+}
+
+template <typename T>
+static double readValue(const void* ptr, ptrdiff_t stride, size_t idx) {
+
+    return (double)*(const T*)((const uint8_t*)ptr + stride * (ptrdiff_t)idx);
+}
+
+void PlotSeries::setData(py::array& x, py::array& y, double xScale, double xStart) {
+
+    PlotArrayInfo pai = interpretPlotArrays(x, y, xScale, xStart);
+
+    std::vector<double> xs(pai.count);
+    std::vector<double> ys(pai.count);
+
+    dispatchDataType(pai.dataType, [&](auto t) {
+        using T = decltype(t);
+        for (size_t i = 0; i < pai.count; ++i) {
+            if (pai.implicitX) {
+                xs[i] = pai.xStart + pai.xScale * (double)i;
+            } else {
+                xs[i] = readValue<T>(pai.xDataPtr, pai.xStride, i);
+            }
+            ys[i] = readValue<T>(pai.yDataPtr, pai.yStride, i);
+        }
+    });
+
+    // compute bounds for fitting and the offset for storage
+
+    boundsMin = ImPlotPoint(HUGE_VAL, HUGE_VAL);
+    boundsMax = ImPlotPoint(-HUGE_VAL, -HUGE_VAL);
+
+    for (size_t i = 0; i < pai.count; ++i) {
+        if (isFiniteValue(xs[i])) {
+            boundsMin.x = ImMin(boundsMin.x, xs[i]);
+            boundsMax.x = ImMax(boundsMax.x, xs[i]);
+        }
+        if (isFiniteValue(ys[i])) {
+            boundsMin.y = ImMin(boundsMin.y, ys[i]);
+            boundsMax.y = ImMax(boundsMax.y, ys[i]);
+        }
+    }
+
+    if (boundsMin.x > boundsMax.x || boundsMin.y > boundsMax.y) {
+        offset = ImPlotPoint(0.0, 0.0);
+    } else if (pai.count > 0) {
+        offset = ImPlotPoint((boundsMin.x + boundsMax.x) * 0.5,
+                             (boundsMin.y + boundsMax.y) * 0.5);
+    } else {
+        offset = ImPlotPoint(0.0, 0.0);
+    }
+
+    if (buffer == nullptr) {
+        buffer = std::make_shared<PlotSeriesBuffer>();
+    }
+
+    // the runs of finite points are found once here instead of
+    // checking every point while drawing
+
+    std::vector<float> vertices(2 * pai.count);
+
+    buffer->runFirst.clear();
+    buffer->runCount.clear();
+
+    GLint runStart = -1;
+
+    for (size_t i = 0; i < pai.count; ++i) {
+
+        vertices[2 * i] = (float)(xs[i] - offset.x);
+        vertices[2 * i + 1] = (float)(ys[i] - offset.y);
+
+        bool finite = isFiniteValue(xs[i]) && isFiniteValue(ys[i]);
+
+        if (finite && runStart < 0) {
+            runStart = (GLint)i;
+        } else if (!finite && runStart >= 0) {
+            buffer->runFirst.push_back(runStart);
+            buffer->runCount.push_back((GLsizei)i - runStart);
+            runStart = -1;
+        }
+    }
+
+    if (runStart >= 0) {
+        buffer->runFirst.push_back(runStart);
+        buffer->runCount.push_back((GLsizei)pai.count - runStart);
+    }
+
+    // upload, the buffer is only reallocated if the data grows
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer->vbo);
+
+    if (pai.count > buffer->capacity) {
+        glBufferData(GL_ARRAY_BUFFER,
+                     vertices.size() * sizeof(float),
+                     vertices.data(),
+                     GL_STATIC_DRAW);
+        buffer->capacity = pai.count;
+    } else if (pai.count > 0) {
+        glBufferSubData(GL_ARRAY_BUFFER,
+                        0,
+                        vertices.size() * sizeof(float),
+                        vertices.data());
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    count = pai.count;
+}
+
+static void setupAxis(PlotSeriesDrawCmd& dc, int i, ImPlotAxis& axis, double offset) {
+
+    if (axis.Scale == ImPlotScale_Log10) {
+        dc.axisMode[i] = 1;
+    } else if (axis.Scale == ImPlotScale_SymLog) {
+        dc.axisMode[i] = 2;
+    } else {
+        dc.axisMode[i] = 0;
+    }
+
+    // the offset is folded into the linear mapping in double precision
+    dc.offset[i] = (float)offset;
+    dc.linearScale[i] = (float)axis.ScaleToPixel;
+    dc.linearShift[i] = (float)(axis.PixelMin
+            + axis.ScaleToPixel * (offset - axis.Range.Min));
+
+    dc.scaleMin[i] = (float)axis.ScaleMin;
+    dc.scaleMax[i] = (float)axis.ScaleMax;
+    dc.pixelMin[i] = axis.PixelMin;
+    dc.pixelSpan[i] = axis.PixelMax - axis.PixelMin;
+}
+
+static void renderSeries(const ImDrawList*, const ImDrawCmd* cmd) {
+
+    static GLuint program = 0;
+
+    if (program == 0) {
+        program = compileShaderProgram(seriesVertexShader,
+                                       seriesGeometryShader,
+                                       seriesFragmentShader);
+    }
+
+    PlotSeriesDrawCmd& dc = *(PlotSeriesDrawCmd*)cmd->UserCallbackData;
+
+    // the backend does not set the scissor rect for callbacks
+
+    if (!applyCallbackScissor(cmd)) {
+        return;
+    }
+
+    ImDrawData* drawData = ImGui::GetDrawData();
+
+    glUseProgram(program);
+
+    glUniform2i(glGetUniformLocation(program, "axisMode"), dc.axisMode[0], dc.axisMode[1]);
+    glUniform2fv(glGetUniformLocation(program, "offset"), 1, dc.offset);
+    glUniform2fv(glGetUniformLocation(program, "linearScale"), 1, dc.linearScale);
+    glUniform2fv(glGetUniformLocation(program, "linearShift"), 1, dc.linearShift);
+    glUniform2fv(glGetUniformLocation(program, "scaleMin"), 1, dc.scaleMin);
+    glUniform2fv(glGetUniformLocation(program, "scaleMax"), 1, dc.scaleMax);
+    glUniform2fv(glGetUniformLocation(program, "pixelMin"), 1, dc.pixelMin);
+    glUniform2fv(glGetUniformLocation(program, "pixelSpan"), 1, dc.pixelSpan);
+
+    glUniform2f(glGetUniformLocation(program, "displayPos"),
+                drawData->DisplayPos.x,
+                drawData->DisplayPos.y);
+    glUniform2f(glGetUniformLocation(program, "displaySize"),
+                drawData->DisplaySize.x,
+                drawData->DisplaySize.y);
+    glUniform1f(glGetUniformLocation(program, "weight"), dc.weight);
+    glUniform4f(glGetUniformLocation(program, "color"),
+                dc.color.x,
+                dc.color.y,
+                dc.color.z,
+                dc.color.w);
+
+    glBindVertexArray(dc.buffer->vao);
+    glMultiDrawArrays(GL_LINE_STRIP,
+                      dc.buffer->runFirst.data(),
+                      dc.buffer->runCount.data(),
+                      (GLsizei)dc.buffer->runFirst.size());
+}
+
+void PlotSeries::plot(const char* label, ImPlotItemFlags flags) {
+
+    if (ImPlot::BeginItem(label, flags, ImPlotCol_Line)) {
+
+        ImPlotPlot& plot = *ImPlot::GetCurrentPlot();
+        ImPlotAxis& xAxis = plot.Axes[plot.CurrentX];
+        ImPlotAxis& yAxis = plot.Axes[plot.CurrentY];
+
+        if (ImPlot::FitThisFrame() && count > 0) {
+            xAxis.ExtendFit(boundsMin.x);
+            xAxis.ExtendFit(boundsMax.x);
+            yAxis.ExtendFit(boundsMin.y);
+            yAxis.ExtendFit(boundsMax.y);
+        }
+
+        const ImPlotNextItemData& s = ImPlot::GetItemData();
+
+        if (count > 1 && s.RenderLine) {
+
+            // commands of the previous frame have been rendered already
+
+            if (drawCmdsFrame != ImGui::GetFrameCount()) {
+                drawCmds.clear();
+                drawCmdsFrame = ImGui::GetFrameCount();
+            }
+
+            PlotSeriesDrawCmd& dc = drawCmds.emplace_back();
+
+            dc.buffer = buffer;
+            dc.count = (int)count;
+
+            setupAxis(dc, 0, xAxis, offset.x);
+            setupAxis(dc, 1, yAxis, offset.y);
+
+            dc.color = ImGui::ColorConvertU32ToFloat4(
+                    ImGui::GetColorU32(s.Colors[ImPlotCol_Line]));
+            dc.weight = s.LineWeight;
+
+            ImDrawList& drawList = *ImPlot::GetPlotDrawList();
+            drawList.AddCallback(renderSeries, &dc);
+            drawList.AddCallback(ImDrawCallback_ResetRenderState, nullptr);
+        }
+
+        ImPlot::EndItem();
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "binding_helpers.hpp"
+
+/**
+ * The GL objects of a plot series.
+ *
+ * These are shared with the pending draw commands, so that a series
+ * can be destroyed before the frame containing it has been rendered.
+ */
+
+struct PlotSeriesBuffer {
+
+    GLuint vao = 0;
+    GLuint vbo = 0;
+
+    // number of points the buffer was allocated for
+    size_t capacity = 0;
+
+    // first point and number of points of each run of finite points,
+    // which are drawn as separate strips, so that NaN points leave gaps
+    std::vector<GLint> runFirst;
+    std::vector<GLsizei> runCount;
+
+    PlotSeriesBuffer();
+    ~PlotSeriesBuffer();
+};
+
+/**
+ * A line series, which keeps its points in a GL vertex buffer.
+ *
+ * The points are only uploaded when the data changes. Drawing a series
+ * submits a single ImDrawList callback and the plot to pixel transform
+ * is done in a shader, so static series cost almost no CPU time.
+ *
+ * Points are stored as floats relative to the center of their bounds,
+ * which keeps the precision for data far away from the origin.
+ * Linear, time, log10 and symlog axes are supported.
+ */
+
+struct PlotSeries {
+
+    std::shared_ptr<PlotSeriesBuffer> buffer;
+
+    size_t count = 0;
+
+    ImPlotPoint offset;
+    ImPlotPoint boundsMin;
+    ImPlotPoint boundsMax;
+
+    void setData(py::array& x,
+                 py::array& y,
+                 double xScale = 1.0,
+                 double xStart = 0.0);
+
+    void plot(const char* label,
+              ImPlotItemFlags flags = ImPlotItemFlags_None);
+};
@@ -0,0 +1,249 @@
+#include "ring_buffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+// number of samples per block of the cached channel ranges
+static constexpr size_t RANGE_BLOCK = 1024;
+
+RingBuffer::RingBuffer(size_t capacity, size_t channels, py::dtype dtype) :
+    capacity(capacity),
+    channels(channels) {
+
+    if (capacity == 0 || channels == 0) {
+        throw py::value_error("RingBuffer capacity and channels must be > 0");
+    }
+
+    py::array probe(dtype, std::vector<py::ssize_t>{0});
+    dataType = interpretDataType(probe);
+
+    if (dataType == PlotDataType::Unknown) {
+        dataType = PlotDataType::Float64;
+        dtype = py::dtype::of<double>();
+    }
+
+    data = py::array(dtype, {channels, capacity});
+
+    size_t blocks = (capacity + RANGE_BLOCK - 1) / RANGE_BLOCK;
+    blockRanges.resize(blocks * channels);
+    blockFinite.resize(blocks * channels);
+    dirtyBlocks.assign(blocks, 1);
+}
+
+void RingBuffer::append(py::array& samples) {
+
+    dispatchDataType(dataType, [&](auto tag) {
+
+        using T = decltype(tag);
+
+        array_like<T> arr = array_like<T>::ensure(samples);
+
+        if (!arr) {
+            throw std::runtime_error("Cannot convert samples to the buffer dtype");
+        }
+
+        size_t count = 0;
+
+        if (arr.ndim() == 1 && channels == 1) {
+            count = arr.shape(0);
+        } else if (arr.ndim() == 1 && (size_t)arr.shape(0) == channels) {
+            count = 1;
+        } else if (arr.ndim() == 2 && (size_t)arr.shape(0) == channels) {
+            count = arr.shape(1);
+        } else {
+            std::stringstream ss;
+            ss << "Expected samples of shape ("
+               << channels
+               << ", n), got "
+               << shapeToStr(arr);
+            throw py::value_error(ss.str());
+        }
+
+        if (count == 0) {
+            return;
+        }
+
+        // only the newest samples survive if more than capacity are given
+
+        size_t skip = count > capacity ? count - capacity : 0;
+        size_t written = count - skip;
+        size_t start = (head + size + skip) % capacity;
+
+        // the first block reaches until the end of the buffer, the
+        // second one wraps around to its beginning
+
+        size_t first = std::min(written, capacity - start);
+        size_t second = written - first;
+
+        const T* src = arr.data();
+        T* dst = (T*)data.mutable_data();
+
+        for (size_t c = 0; c < channels; ++c) {
+            const T* srcRow = src + c * count + skip;
+            T* dstRow = dst + c * capacity;
+            std::memcpy(dstRow + start, srcRow, first * sizeof(T));
+            std::memcpy(dstRow, srcRow + first, second * sizeof(T));
+        }
+
+        auto markDirty = [&](size_t from, size_t n) {
+            if (n > 0) {
+                size_t last = (from + n - 1) / RANGE_BLOCK;
+                for (size_t b = from / RANGE_BLOCK; b <= last; ++b) {
+                    dirtyBlocks[b] = 1;
+                }
+            }
+        };
+
+        markDirty(start, first);
+        markDirty(0, second);
+
+        size = std::min(size + count, capacity);
+        head = (start + written + capacity - size) % capacity;
+        total += count;
+    });
+}
+
+void RingBuffer::clear() {
+
+    head = 0;
+    size = 0;
+    total = 0;
+
+    std::fill(dirtyBlocks.begin(), dirtyBlocks.end(), 1);
+}
+
+py::array RingBuffer::toArray() {
+
+    py::array result(data.dtype(), {channels, size});
+
+    size_t itemSize = data.itemsize();
+    size_t first = std::min(size, capacity - head);
+    size_t second = size - first;
+
+    const uint8_t* src = (const uint8_t*)data.data();
+    uint8_t* dst = (uint8_t*)result.mutable_data();
+
+    for (size_t c = 0; c < channels; ++c) {
+        const uint8_t* srcRow = src + c * capacity * itemSize;
+        uint8_t* dstRow = dst + c * size * itemSize;
+        std::memcpy(dstRow, srcRow + head * itemSize, first * itemSize);
+        std::memcpy(dstRow + first * itemSize, srcRow, second * itemSize);
+    }
+
+    return result;
+}
+
+ImPlotRange RingBuffer::channelRange(int channel, bool* finite) {
+
+    // the head stays at zero until the buffer is full, so the valid
+    // samples are always a prefix of the storage
+
+    size_t validEnd = std::min(size, capacity);
+    size_t blocks = (validEnd + RANGE_BLOCK - 1) / RANGE_BLOCK;
+    size_t itemSize = data.itemsize();
+
+    const uint8_t* base = (const uint8_t*)data.data();
+
+    dispatchDataType(dataType, [&](auto tag) {
+
+        using T = decltype(tag);
+
+        for (size_t b = 0; b < blocks; ++b) {
+
+            if (!dirtyBlocks[b]) {
+                continue;
+            }
+
+            size_t from = b * RANGE_BLOCK;
+            size_t n = std::min(RANGE_BLOCK, validEnd - from);
+
+            for (size_t c = 0; c < channels; ++c) {
+
+                const T* values = (const T*)(base + (c * capacity + from) * itemSize);
+
+                ImPlotRange range(HUGE_VAL, -HUGE_VAL);
+                extendFiniteRange<T>(range, values, n, itemSize);
+                blockRanges[b * channels + c] = range;
+
+                bool allFinite = true;
+                for (size_t i = 0; i < n; ++i) {
+                    allFinite &= isFiniteValue(values[i]);
+                }
+                blockFinite[b * channels + c] = allFinite;
+            }
+
+            dirtyBlocks[b] = 0;
+        }
+    });
+
+    ImPlotRange result(HUGE_VAL, -HUGE_VAL);
+    bool allFinite = true;
+
+    for (size_t b = 0; b < blocks; ++b) {
+        const ImPlotRange& range = blockRanges[b * channels + channel];
+        result.Min = std::min(result.Min, range.Min);
+        result.Max = std::max(result.Max, range.Max);
+        allFinite &= blockFinite[b * channels + channel] != 0;
+    }
+
+    if (finite != nullptr) {
+        *finite = allFinite;
+    }
+
+    return result;
+}
+
+PlotArrayInfo RingBuffer::plotArrays(int channel, int xChannel, double xScale, double xStart) {
+
+    if (channel < 0 || (size_t)channel >= channels) {
+        throw py::value_error("Invalid channel " + std::to_string(channel));
+    }
+    if (xChannel >= 0 && (size_t)xChannel >= channels) {
+        throw py::value_error("Invalid x channel " + std::to_string(xChannel));
+    }
+
+    size_t itemSize = data.itemsize();
+    const uint8_t* base = (const uint8_t*)data.data();
+
+    PlotArrayInfo info;
+
+    info.xArray = data;
+    info.yArray = data;
+    info.dataType = dataType;
+
+    info.yDataPtr = base + channel * capacity * itemSize;
+    info.yStride = itemSize;
+
+    if (xChannel < 0) {
+        info.implicitX = true;
+        info.monotonicX = true;
+        info.xScale = xScale;
+        info.xStart = xStart + xScale * (double)(total - size);
+    } else {
+        info.xDataPtr = base + xChannel * capacity * itemSize;
+        info.xStride = itemSize;
+    }
+
+    info.ringOffset = head;
+    info.ringCapacity = capacity;
+    info.count = size;
+
+    bool yFinite = false;
+    bool xFinite = true;
+
+    info.hasBounds = true;
+    info.bounds.Y = channelRange(channel, &yFinite);
+
+    if (info.implicitX) {
+        double last = info.xStart + xScale * (double)(size - 1);
+        info.bounds.X = ImPlotRange(std::min(info.xStart, last), std::max(info.xStart, last));
+    } else {
+        info.bounds.X = channelRange(xChannel, &xFinite);
+    }
+
+    info.finite = xFinite && yFinite;
+
+    return info;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+
+#include "binding_helpers.hpp"
+
+/**
+ * A fixed capacity, multi-channel ring buffer for streaming plots.
+ *
+ * Appending overwrites the oldest samples once the buffer is full.
+ * Plotting reads the samples in place and handles the wraparound in
+ * the indexer, so scrolling plots need no copies.
+ */
+
+struct RingBuffer {
+
+    // one row of capacity elements per channel
+    py::array data;
+    PlotDataType dataType = PlotDataType::Float64;
+
+    size_t capacity = 0;
+    size_t channels = 0;
+
+    // position of the oldest sample and number of valid samples
+    size_t head = 0;
+    size_t size = 0;
+
+    // number of samples appended since creation or the last clear
+    size_t total = 0;
+
+    // range of the finite values per block of samples and channel,
+    // blocks are only reduced again after they have been written to
+    std::vector<ImPlotRange> blockRanges;
+    std::vector<uint8_t> blockFinite;
+    std::vector<uint8_t> dirtyBlocks;
+
+    RingBuffer(size_t capacity, size_t channels, py::dtype dtype);
+
+    /**
+     * Appends samples of shape (channels, n) or (channels,).
+     * Single channel buffers also accept a 1-D array of samples.
+     */
+    void append(py::array& samples);
+
+    void clear();
+
+    /**
+     * Returns a copy of the valid samples in chronological order.
+     */
+    py::array toArray();
+
+    /**
+     * Range of the finite values of a channel. The cost depends on the
+     * number of blocks and the samples appended since the last call,
+     * but not on the number of samples in the buffer.
+     *
+     * If given, finite is set to whether all values are finite.
+     */
+    ImPlotRange channelRange(int channel, bool* finite = nullptr);
+
+    /**
+     * Describes a channel for plotting without copying its data.
+     *
+     * If xChannel is negative, x is given implicitly by the sample
+     * number, so that the plot scrolls with the appended data.
+     */
+    PlotArrayInfo plotArrays(int channel,
+                             int xChannel = -1,
+                             double xScale = 1.0,
+                             double xStart = 0.0);
+};
@@ -0,0 +1,132 @@
+#include "thread_pool.hpp"
+
+ThreadPool::~ThreadPool() {
+
+    stopWorkers();
+}
+
+void ThreadPool::resize(size_t workerCount) {
+
+    if (workerCount == workers.size()) {
+        return;
+    }
+
+    stopWorkers();
+
+    stop = false;
+
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+void ThreadPool::stopWorkers() {
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wake.notify_all();
+
+    for (std::thread& t : workers) {
+        t.join();
+    }
+
+    workers.clear();
+}
+
+void ThreadPool::runTasks(const std::function<void(int)>* func, int count) {
+
+    while (true) {
+
+        int i = nextTask.fetch_add(1);
+
+        if (i >= count) {
+            break;
+        }
+
+        (*func)(i);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (++finished == count) {
+            done.notify_all();
+        }
+    }
+}
+
+void ThreadPool::work() {
+
+    size_t seen = 0;
+
+    while (true) {
+
+        const std::function<void(int)>* func = nullptr;
+        int count = 0;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&]{ return stop || generation != seen; });
+
+            if (stop) {
+                return;
+            }
+
+            seen = generation;
+
+            // the job may already be finished if this worker woke up late
+            if (task == nullptr) {
+                continue;
+            }
+
+            func = task;
+            count = taskCount;
+            ++active;
+        }
+
+        runTasks(func, count);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        --active;
+        done.notify_all();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)>& func) {
+
+    if (count <= 0) {
+        return;
+    }
+
+    if (workers.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) {
+            func(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &func;
+        taskCount = count;
+        finished = 0;
+        nextTask = 0;
+        ++generation;
+    }
+
+    wake.notify_all();
+
+    runTasks(&func, count);
+
+    // workers must not reference the job after returning
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&]{ return finished == taskCount && active == 0; });
+    task = nullptr;
+}
+
+ThreadPool& getThreadPool() {
+
+    static ThreadPool pool;
+
+    return pool;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A minimal pool of worker threads for data parallel work.
+ *
+ * parallelFor blocks until all tasks are done. The calling thread
+ * works on the tasks as well, so a pool without workers simply
+ * runs everything sequentially.
+ */
+
+struct ThreadPool {
+
+    ~ThreadPool();
+
+    void resize(size_t workerCount);
+
+    size_t size() const { return workers.size(); }
+
+    void parallelFor(int count, const std::function<void(int)>& func);
+
+private:
+
+    void work();
+    void runTasks(const std::function<void(int)>* func, int count);
+    void stopWorkers();
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    // the current job, guarded by mutex
+    const std::function<void(int)>* task = nullptr;
+    int taskCount = 0;
+    int finished = 0;
+    int active = 0;
+    size_t generation = 0;
+    bool stop = false;
+
+    std::atomic<int> nextTask{0};
+};
+
+ThreadPool& getThreadPool();
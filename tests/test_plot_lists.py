@@ -0,0 +1,53 @@
+"""
+Plotting functions accept plain lists and scalars, not only arrays.
+
+Needs the built module and a display to open the window.
+"""
+
+import os
+
+import pytest
+
+viz = pytest.importorskip("imviz")
+
+if not os.environ.get("DISPLAY") and not os.environ.get("WAYLAND_DISPLAY"):
+    pytest.skip("no display available", allow_module_level=True)
+
+
+def test_plot_lists():
+
+    viz.wait()
+
+    if viz.begin_window("lists"):
+        if viz.begin_plot("lists"):
+            viz.plot([1, 2, 3], [1, 2, 3], shade=[2, 1, 3], label="line")
+            viz.plot([1, 2, 3], lower=[1, 1, 1], upper=[2, 2, 2], label="band")
+            viz.plot([], label="empty")
+            viz.plot([1, 2], [1, 2], fmt="o", color=[[1, 0, 0, 1], [0, 1, 0, 1]])
+            viz.plot([1, 2, 3], fmt="o", color_values=[1.0, float("nan"), 3.0])
+            viz.plot(5.0, label="scalar")
+            viz.plot_many([[1, 2, 3], [3, 2, 1]], colors=[1, 0, 0])
+            viz.plot_many([[1, 2, 3], [3, 2, 1]], colors=["r", (0, 1, 0)])
+            viz.plot_bars([1, 2, 3, 4], label="bars")
+            viz.plot_vlines("vlines", [1, 4, 6, 8])
+            viz.plot_hlines("hlines", [1, 4, 6, 8])
+            viz.plot_histogram([1, 2, 2, 3, 3, 3], label="histogram")
+            viz.plot_series(viz.PlotSeries([1, 2, 3], [3, 2, 1]))
+            viz.end_plot()
+        viz.end_window()
+
+    viz.wait()
+
+
+def test_plot_band_needs_both_bounds():
+
+    viz.wait()
+
+    if viz.begin_window("bounds"):
+        if viz.begin_plot("bounds"):
+            with pytest.raises(ValueError):
+                viz.plot([1, 2, 3], lower=[1, 1, 1], label="band")
+            viz.end_plot()
+        viz.end_window()
+
+    viz.wait()